@@ -0,0 +1,302 @@
+// batchEnv.h - N jocuri independente simulate in lockstep, fara GL
+// Header-only, se pune langa main.cpp (ca fastRandom.h).
+//
+// Starea e SoA peste instante: toate playerX-urile sunt contigue, iar coloanele
+// masinilor/monedelor sunt contigue per instanta ([i * carsPerInstance + k]).
+// step() primeste un vector de actiuni (bitii ACT_*) si scrie reward/done/score.
+//
+// Regulile sunt aceleasi ca in stepGame() din main.cpp, iar deciziile aleatoare
+// vin din philox4x32() cu aceleasi chei, deci o instanta pornita din aceeasi
+// stare ca jocul scalar produce exact aceleasi valori (verificat cu
+// --check-divergence). Trail-ul si liniile intrerupte sunt doar grafica si nu
+// sunt simulate aici.
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "fastRandom.h"
+
+// Actiunile jucatorului pentru un tick (aceiasi biti ca readInputActions()).
+enum { ACT_UP = 1, ACT_DOWN = 2, ACT_LEFT = 4, ACT_RIGHT = 8 };
+
+// Parametrii jocului; valorile implicite sunt cele din main.cpp.
+struct BatchConfig {
+    int numAiCars = 50;
+    int laneNumLeft = 18, laneNumRight = 18;
+    float laneWidth = 0.6f;
+    float carWidth = 0.1f, carHeight = 0.2f;
+    float playerAcc = 0.0001f, maxSpeed = 0.02f, minSpeed = -0.02f;
+    float aiSpeed = 0.008f;
+    float aiMinY = 0.5f, aiMaxY = 8.0f;
+    float aiSpawnAheadMin = 2.0f, aiSpawnAheadMax = 4.0f;
+    float rewardSpeed = 0.008f;
+    int targetRewards = 12;
+    int maxRewards = 256;
+    float spawnProbBase = 0.002f, spawnProbSpeedScale = 6.0f, spawnProbMax = 0.15f;
+};
+
+struct BatchEnv {
+    BatchConfig cfg;
+    int numInstances = 0;
+    int carsPerInstance = 0;
+    int rewardCapacity = 0;
+    std::vector<float> laneCenters;
+
+    // per instanta
+    std::vector<float> playerX, playerY, playerSpeed, drift, rotSmooth;
+    std::vector<int32_t> score;
+    std::vector<uint8_t> gameOver;
+    std::vector<uint64_t> tick, seed;
+
+    // masini: [i * carsPerInstance + k]
+    std::vector<float> carX, carY, carSpeed;
+
+    // monede: [i * rewardCapacity + k], primele rewardCount[i] sunt valide
+    std::vector<float> rewardX, rewardY;
+    std::vector<int32_t> rewardCount;
+
+    std::vector<float> scratchY; // carsPerInstance, pentru calea rapida
+
+    // Optional: stari de start precalculate (aceeasi configuratie, vezi buildStartStates).
+    // Daca e setat, autoReset() copiaza una dintre ele in loc sa genereze lumea.
+    // Se seteaza prin setStartStates(), care respinge pool-urile incompatibile.
+    const BatchEnv* startStates = nullptr;
+
+    void init(const BatchConfig& config, int instances, uint64_t baseSeed) {
+        cfg = config;
+        numInstances = instances;
+        carsPerInstance = cfg.numAiCars;
+        rewardCapacity = cfg.maxRewards;
+
+        laneCenters.clear();
+        for (int i = -cfg.laneNumLeft; i <= cfg.laneNumRight; ++i)
+            laneCenters.push_back(i * cfg.laneWidth + cfg.laneWidth * 0.5f);
+
+        size_t n = (size_t)instances;
+        playerX.assign(n, 0.0f); playerY.assign(n, 0.0f); playerSpeed.assign(n, 0.0f);
+        drift.assign(n, 0.0f); rotSmooth.assign(n, 0.0f);
+        score.assign(n, 0); gameOver.assign(n, 0);
+        tick.assign(n, 0); seed.resize(n);
+        carX.assign(n * carsPerInstance, 0.0f); carY.assign(n * carsPerInstance, 0.0f); carSpeed.assign(n * carsPerInstance, 0.0f);
+        rewardX.assign(n * rewardCapacity, 0.0f); rewardY.assign(n * rewardCapacity, 0.0f);
+        rewardCount.assign(n, 0);
+        scratchY.assign(carsPerInstance, 0.0f);
+
+        uint64_t x = baseSeed;
+        for (size_t i = 0; i < n; ++i) seed[i] = BlockRng::splitmix64(x);
+        for (int i = 0; i < instances; ++i) reset(i);
+    }
+
+    // Reinitializeaza instanta i in spatiul deja alocat (fara push_back).
+    void reset(int i) {
+        playerX[i] = 0.0f; playerY[i] = 0.0f; playerSpeed[i] = 0.0f; drift[i] = 0.0f; rotSmooth[i] = 0.0f;
+        score[i] = 0; gameOver[i] = 0;
+        const int L = (int)laneCenters.size();
+        float* cx = &carX[(size_t)i * carsPerInstance];
+        float* cy = &carY[(size_t)i * carsPerInstance];
+        float* cs = &carSpeed[(size_t)i * carsPerInstance];
+        for (int k = 0; k < carsPerInstance; ++k) {
+            Philox4 r = philox4x32(seed[i], tick[i], (uint32_t)k, rngPurpose(RNG_RESET_CAR, 0));
+            cx[k] = laneCenters[rngInt(r.v[0], 0, L - 1)];
+            const float safeAhead = 1.0f;
+            cy[k] = playerY[i] + safeAhead + rngRange(r.v[1], cfg.aiMinY, cfg.aiMaxY);
+            cs[k] = cfg.aiSpeed * rngRange(r.v[2], 0.9f, 1.4f);
+        }
+        rewardCount[i] = 0;
+        for (int k = 0; k < 8; ++k) {
+            Philox4 r = philox4x32(seed[i], tick[i], (uint32_t)k, rngPurpose(RNG_RESET_REWARD, 0));
+            spawnReward(i, r.v[0], r.v[1]);
+        }
+    }
+
+    // Aceleasi dimensiuni si aceleasi benzi: copyInstance() poate muta instante intre ele.
+    bool sameLayout(const BatchEnv& o) const {
+        return carsPerInstance == o.carsPerInstance && rewardCapacity == o.rewardCapacity && laneCenters == o.laneCenters;
+    }
+
+    // false (si startStates ramane nullptr) daca pool-ul are alt numar de masini,
+    // alta capacitate de monede sau alte benzi decat mediul acesta.
+    bool setStartStates(const BatchEnv* pool) {
+        startStates = nullptr;
+        if (pool && !sameLayout(*pool)) return false;
+        startStates = pool;
+        return true;
+    }
+
+    // Episod nou pentru instanta i, in spatiul deja alocat. Cu startStates, lumea vine
+    // dintr-o stare aleasa cu Philox (cheia si tick-ul instantei); seed[i] si tick[i]
+    // raman ale instantei, deci episoadele pornite din aceeasi stare se despart imediat.
+    void autoReset(int i) {
+        if (!startStates || startStates->numInstances == 0) { reset(i); return; }
+        Philox4 r = philox4x32(seed[i], tick[i], 0, rngPurpose(RNG_START_STATE, 0));
+        const uint64_t keepSeed = seed[i], keepTick = tick[i];
+        copyInstance(*startStates, rngInt(r.v[0], 0, startStates->numInstances - 1), i);
+        seed[i] = keepSeed; tick[i] = keepTick;
+        score[i] = 0; gameOver[i] = 0;
+    }
+
+    // Copiaza instanta s din src peste instanta d (aceeasi configuratie, src poate fi *this).
+    void copyInstance(const BatchEnv& src, int s, int d) {
+        assert(sameLayout(src));
+        playerX[d] = src.playerX[s]; playerY[d] = src.playerY[s]; playerSpeed[d] = src.playerSpeed[s];
+        drift[d] = src.drift[s]; rotSmooth[d] = src.rotSmooth[s];
+        score[d] = src.score[s]; gameOver[d] = src.gameOver[s];
+        tick[d] = src.tick[s]; seed[d] = src.seed[s];
+        const size_t C = (size_t)carsPerInstance;
+        memcpy(&carX[d * C], &src.carX[s * C], C * sizeof(float));
+        memcpy(&carY[d * C], &src.carY[s * C], C * sizeof(float));
+        memcpy(&carSpeed[d * C], &src.carSpeed[s * C], C * sizeof(float));
+        const size_t n = (size_t)src.rewardCount[s];
+        if (n) {
+            memcpy(&rewardX[(size_t)d * rewardCapacity], &src.rewardX[(size_t)s * src.rewardCapacity], n * sizeof(float));
+            memcpy(&rewardY[(size_t)d * rewardCapacity], &src.rewardY[(size_t)s * src.rewardCapacity], n * sizeof(float));
+        }
+        rewardCount[d] = (int32_t)n;
+    }
+
+    void spawnReward(int i, uint32_t laneBits, uint32_t aheadBits) {
+        if (rewardCount[i] >= rewardCapacity) return;
+        size_t k = (size_t)i * rewardCapacity + rewardCount[i]++;
+        rewardX[k] = laneCenters[rngInt(laneBits, 0, (int)laneCenters.size() - 1)];
+        rewardY[k] = playerY[i] + rngRange(aheadBits, 2.0f, 5.0f);
+    }
+
+    // Un tick pentru toate instantele. reward = monede luate in tick-ul acesta,
+    // done = instanta e in game over (ramane asa pana la reset()).
+    // Oricare dintre reward/done/scoreOut poate fi nullptr.
+    // resetDone: instantele terminate pornesc imediat un episod nou (autoReset());
+    // done/scoreOut raman cele ale episodului terminat.
+    void step(const uint8_t* actions, float* reward, uint8_t* done, int32_t* scoreOut, bool resetDone = false) {
+        stepRange(0, numInstances, actions, reward, done, scoreOut, nullptr, resetDone);
+    }
+
+    // [begin, end) - folosit si de pool-ul de thread-uri pe bucati disjuncte.
+    // actions are end - begin valori (actions[0] e pentru instanta begin);
+    // reward/done/scoreOut se indexeaza global. scratch: carsPerInstance float-uri proprii apelantului.
+    void stepRange(int begin, int end, const uint8_t* actions, float* reward, uint8_t* done, int32_t* scoreOut,
+                   float* scratch = nullptr, bool resetDone = false) {
+        if (!scratch) scratch = scratchY.data();
+        stepPlayers(begin, end, actions);
+        for (int i = begin; i < end; ++i) {
+            int32_t before = score[i];
+            if (!gameOver[i]) stepWorld(i, scratch);
+            if (reward) reward[i] = (float)(score[i] - before);
+            if (done) done[i] = gameOver[i];
+            if (scoreOut) scoreOut[i] = score[i];
+            if (resetDone && gameOver[i]) autoReset(i);
+        }
+    }
+
+    // Jucatorii tuturor instantelor, pe coloane (bucla fara dependente intre instante).
+    // actions[i - begin] ca la stepRange().
+    void stepPlayers(int begin, int end, const uint8_t* actions) {
+        const float leftLimit = -cfg.laneNumLeft * cfg.laneWidth + cfg.carWidth / 2.0f;
+        const float rightLimit = cfg.laneNumRight * cfg.laneWidth - cfg.carWidth / 2.0f;
+        for (int i = begin; i < end; ++i) {
+            if (gameOver[i]) continue;
+            ++tick[i];
+            unsigned a = actions ? actions[i - begin] : 0;
+            float sp = playerSpeed[i];
+            if (a & ACT_UP) { sp += cfg.playerAcc; if (sp > cfg.maxSpeed) sp = cfg.maxSpeed; }
+            else if (a & ACT_DOWN) { sp -= cfg.playerAcc; if (sp < cfg.minSpeed) sp = cfg.minSpeed; }
+            else sp = 0.0f;
+            playerSpeed[i] = sp;
+
+            float px = playerX[i], dr = drift[i];
+            if (a & ACT_LEFT) { px -= 0.009f; dr += 0.05f; if (dr > 10.0f) dr = 10.0f; }
+            else if (a & ACT_RIGHT) { px += 0.009f; dr -= 0.05f; if (dr < -10.0f) dr = -10.0f; }
+            else dr *= 0.9f;
+            float rot = rotSmooth[i] * 0.9f + dr * 0.1f;
+            if (px < leftLimit) { px = leftLimit; dr = 0.0f; rot = 0.0f; }
+            if (px > rightLimit) { px = rightLimit; dr = 0.0f; rot = 0.0f; }
+            playerX[i] = px; drift[i] = dr; rotSmooth[i] = rot;
+            playerY[i] += sp;
+        }
+    }
+
+    // Masinile si monedele instantei i (jucatorul e deja mutat).
+    void stepWorld(int i, float* scratch) {
+        const int C = carsPerInstance;
+        float* cx = &carX[(size_t)i * C];
+        float* cy = &carY[(size_t)i * C];
+        const float* cs = &carSpeed[(size_t)i * C];
+        const float px = playerX[i], py = playerY[i];
+        const float respawnBelow = py - 2.0f;
+
+        // Calea rapida: daca nicio masina nu iese in spate, mutarea nu depinde
+        // de ordine si se vectorizeaza; altfel refacem bucla secventiala exacta.
+        int respawns = 0;
+        for (int k = 0; k < C; ++k) {
+            float y = cy[k] - cs[k];
+            scratch[k] = y;
+            respawns += y < respawnBelow;
+        }
+        if (respawns == 0) {
+            int hits = 0;
+            for (int k = 0; k < C; ++k) {
+                cy[k] = scratch[k];
+                hits += (fabsf(px - cx[k]) < cfg.carWidth) & (fabsf(py - cy[k]) < cfg.carHeight);
+            }
+            if (hits) gameOver[i] = 1;
+        }
+        else {
+            const int L = (int)laneCenters.size();
+            for (int k = 0; k < C; ++k) {
+                cy[k] -= cs[k];
+                if (cy[k] < respawnBelow) {
+                    bool overlap = false; int attempts = 0, MAX_ATT = 12;
+                    do {
+                        overlap = false;
+                        Philox4 r = philox4x32(seed[i], tick[i], (uint32_t)k, rngPurpose(RNG_CAR_RESPAWN, attempts));
+                        if (L) cx[k] = laneCenters[rngInt(r.v[0], 0, L - 1)];
+                        cy[k] = py + rngRange(r.v[1], cfg.aiSpawnAheadMin, cfg.aiSpawnAheadMax);
+                        for (int j = 0; j < C; ++j) {
+                            if (j == k) continue;
+                            if (fabsf(cx[j] - cx[k]) < cfg.carWidth * 1.05f && fabsf(cy[j] - cy[k]) < cfg.carHeight * 1.2f) { overlap = true; break; }
+                        }
+                        ++attempts;
+                    } while (overlap && attempts < MAX_ATT);
+                }
+                if (fabsf(px - cx[k]) < cfg.carWidth && fabsf(py - cy[k]) < cfg.carHeight) gameOver[i] = 1;
+            }
+        }
+
+        // monede: mutare + colectare + compactare stabila (ca remove_if)
+        float* rx = &rewardX[(size_t)i * rewardCapacity];
+        float* ry = &rewardY[(size_t)i * rewardCapacity];
+        int n = rewardCount[i], kept = 0;
+        const float removeBelow = py - 5.0f;
+        for (int k = 0; k < n; ++k) {
+            float y = ry[k] - cfg.rewardSpeed;
+            if (fabsf(px - rx[k]) < cfg.carWidth / 2.0f && fabsf(py - y) < cfg.carHeight / 2.0f) { score[i] += 1; continue; }
+            if (y < removeBelow) continue;
+            rx[kept] = rx[k]; ry[kept] = y; ++kept;
+        }
+        rewardCount[i] = kept;
+
+        uint32_t spawnSeq = 0;
+        while (rewardCount[i] < cfg.targetRewards) {
+            Philox4 r = philox4x32(seed[i], tick[i], spawnSeq++, rngPurpose(RNG_REWARD_SPAWN, 0));
+            spawnReward(i, r.v[0], r.v[1]);
+        }
+        float spawnProb = cfg.spawnProbBase + playerSpeed[i] * cfg.spawnProbSpeedScale;
+        if (spawnProb > cfg.spawnProbMax) spawnProb = cfg.spawnProbMax;
+        if (rngFloat01(philox4x32(seed[i], tick[i], 0, rngPurpose(RNG_REWARD_ROLL, 0)).v[0]) < spawnProb) {
+            Philox4 r = philox4x32(seed[i], tick[i], spawnSeq++, rngPurpose(RNG_REWARD_SPAWN, 0));
+            spawnReward(i, r.v[0], r.v[1]);
+        }
+    }
+};
+
+// Umple pool cu count stari de start: lumi generate ca la reset(), apoi lasate sa
+// curga warmupTicks tick-uri cu jucatorul pe loc (traficul nu mai e cel "proaspat").
+// Instantele lovite in warm-up sunt regenerate; scorul porneste de la 0.
+inline void buildStartStates(BatchEnv& pool, const BatchConfig& cfg, int count, uint64_t seed, int warmupTicks = 0) {
+    pool.init(cfg, count, seed);
+    for (int t = 0; t < warmupTicks; ++t) pool.step(nullptr, nullptr, nullptr, nullptr, true);
+    for (int i = 0; i < count; ++i) { pool.score[i] = 0; pool.gameOver[i] = 0; }
+}
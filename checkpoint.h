@@ -0,0 +1,209 @@
+// checkpoint.h - format de checkpoint pentru starea lumii, mapabil direct cu mmap
+// Fara GL, header-only (ca stb_image.h): se pune in acelasi folder cu main.cpp.
+//
+// Layout (little-endian, versionat):
+//   [CheckpointHeader, 256 bytes]
+//   coloane aliniate la CKPT_ALIGN: carX, carY, carSpeed, rewardX, rewardY,
+//   rewardCollected (uint8), trailX, trailY, laneCenters, lineOffsets, rng
+// La incarcare nu se parseaza nimic: pointerii din CheckpointView arata direct
+// in maparea fisierului.
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CKPT_MAGIC "ILCKPT\0"
+#define CKPT_VERSION 2
+#define CKPT_ALIGN 64
+
+enum CheckpointColumn {
+    CKPT_CAR_X, CKPT_CAR_Y, CKPT_CAR_SPEED,
+    CKPT_REWARD_X, CKPT_REWARD_Y, CKPT_REWARD_COLLECTED,
+    CKPT_TRAIL_X, CKPT_TRAIL_Y,
+    CKPT_LANE_CENTERS, CKPT_LINE_OFFSETS,
+    CKPT_RNG,
+    CKPT_NUM_COLUMNS
+};
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+
+    // scalari
+    float playerX, playerY, playerSpeed, rotSmooth, drift;
+    int32_t score;
+    uint32_t gameOver;
+    uint32_t pad0;
+    uint64_t simTick;
+    uint64_t rngSeed;      // cheia Philox (v2)
+    float trailLastX, trailLastY;
+    float lineDashOffset;
+    float camX, camY;
+    float laneWidth;
+    int32_t laneNumLeft, laneNumRight;
+
+    // numar de elemente
+    uint64_t numCars, numRewards, numTrail, numLanes, rngBytes;
+
+    // offset-uri in fisier pentru fiecare coloana
+    uint64_t offset[CKPT_NUM_COLUMNS];
+
+    uint8_t reserved[256 - 144 - 8 * CKPT_NUM_COLUMNS];
+};
+static_assert(sizeof(CheckpointHeader) == 256, "CheckpointHeader must stay 256 bytes");
+
+// Coloanele unei lumi; la scriere vin de la apelant, la citire arata in mapare.
+struct CheckpointView {
+    const CheckpointHeader* header;
+    const float* carX; const float* carY; const float* carSpeed;
+    const float* rewardX; const float* rewardY; const uint8_t* rewardCollected;
+    const float* trailX; const float* trailY;
+    const float* laneCenters; const float* lineOffsets;
+    const void* rng;
+};
+
+inline bool ckptHostIsLittleEndian() { const uint16_t v = 1; uint8_t b; memcpy(&b, &v, 1); return b == 1; }
+
+inline uint64_t ckptAlignUp(uint64_t v) { return (v + CKPT_ALIGN - 1) & ~(uint64_t)(CKPT_ALIGN - 1); }
+
+inline uint64_t ckptColumnBytes(const CheckpointHeader& h, int col) {
+    switch (col) {
+    case CKPT_CAR_X: case CKPT_CAR_Y: case CKPT_CAR_SPEED: return h.numCars * sizeof(float);
+    case CKPT_REWARD_X: case CKPT_REWARD_Y: return h.numRewards * sizeof(float);
+    case CKPT_REWARD_COLLECTED: return h.numRewards;
+    case CKPT_TRAIL_X: case CKPT_TRAIL_Y: return h.numTrail * sizeof(float);
+    case CKPT_LANE_CENTERS: case CKPT_LINE_OFFSETS: return h.numLanes * sizeof(float);
+    case CKPT_RNG: return h.rngBytes;
+    }
+    return 0;
+}
+
+// Completeaza magic/version/offset-uri/fileSize in functie de numarul de elemente.
+inline void ckptLayout(CheckpointHeader& h) {
+    memcpy(h.magic, CKPT_MAGIC, 8);
+    h.version = CKPT_VERSION;
+    h.headerSize = sizeof(CheckpointHeader);
+    uint64_t pos = ckptAlignUp(sizeof(CheckpointHeader));
+    for (int c = 0; c < CKPT_NUM_COLUMNS; ++c) {
+        h.offset[c] = pos;
+        pos = ckptAlignUp(pos + ckptColumnBytes(h, c));
+    }
+    h.fileSize = pos;
+}
+
+// Scrie header-ul (numCars/numRewards/... deja completate) si coloanele din v.
+inline bool writeCheckpoint(const char* path, CheckpointHeader h, const CheckpointView& v) {
+    if (!ckptHostIsLittleEndian()) { fprintf(stderr, "checkpoint: big-endian host not supported\n"); return false; }
+    ckptLayout(h);
+    const void* cols[CKPT_NUM_COLUMNS] = {
+        v.carX, v.carY, v.carSpeed, v.rewardX, v.rewardY, v.rewardCollected,
+        v.trailX, v.trailY, v.laneCenters, v.lineOffsets, v.rng
+    };
+    FILE* f = fopen(path, "wb");
+    if (!f) { fprintf(stderr, "checkpoint: cannot open %s for writing\n", path); return false; }
+    static const uint8_t zeros[CKPT_ALIGN] = { 0 };
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    uint64_t pos = sizeof(h);
+    for (int c = 0; c < CKPT_NUM_COLUMNS && ok; ++c) {
+        if (h.offset[c] > pos) ok = fwrite(zeros, 1, (size_t)(h.offset[c] - pos), f) == h.offset[c] - pos;
+        pos = h.offset[c];
+        uint64_t n = ckptColumnBytes(h, c);
+        if (n && ok) ok = fwrite(cols[c], 1, (size_t)n, f) == n;
+        pos += n;
+    }
+    if (ok && h.fileSize > pos) ok = fwrite(zeros, 1, (size_t)(h.fileSize - pos), f) == h.fileSize - pos;
+    if (fclose(f) != 0) ok = false;
+    if (!ok) fprintf(stderr, "checkpoint: write failed for %s\n", path);
+    return ok;
+}
+
+struct MappedCheckpoint {
+    void* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    CheckpointView view = {};
+};
+
+inline void unmapCheckpoint(MappedCheckpoint& m) {
+#ifdef _WIN32
+    if (m.base) UnmapViewOfFile(m.base);
+    if (m.mapping) CloseHandle(m.mapping);
+    if (m.file != INVALID_HANDLE_VALUE) CloseHandle(m.file);
+    m.file = INVALID_HANDLE_VALUE; m.mapping = nullptr;
+#else
+    if (m.base) munmap(m.base, m.size);
+#endif
+    m.base = nullptr; m.size = 0; m.view = CheckpointView();
+}
+
+// Mapeaza fisierul read-only si valideaza header-ul; coloanele nu se copiaza.
+inline bool mapCheckpoint(const char* path, MappedCheckpoint& m) {
+    if (!ckptHostIsLittleEndian()) { fprintf(stderr, "checkpoint: big-endian host not supported\n"); return false; }
+#ifdef _WIN32
+    m.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m.file == INVALID_HANDLE_VALUE) { fprintf(stderr, "checkpoint: cannot open %s\n", path); return false; }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(m.file, &sz)) { unmapCheckpoint(m); return false; }
+    m.size = (size_t)sz.QuadPart;
+    m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m.mapping) { unmapCheckpoint(m); return false; }
+    m.base = MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m.base) { unmapCheckpoint(m); return false; }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "checkpoint: cannot open %s\n", path); return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    m.size = (size_t)st.st_size;
+    void* p = m.size ? mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED) { fprintf(stderr, "checkpoint: mmap failed for %s\n", path); m.size = 0; return false; }
+    m.base = p;
+#endif
+    const CheckpointHeader* h = (const CheckpointHeader*)m.base;
+    if (m.size < sizeof(CheckpointHeader) || memcmp(h->magic, CKPT_MAGIC, 8) != 0) {
+        fprintf(stderr, "checkpoint: %s is not a checkpoint file\n", path); unmapCheckpoint(m); return false;
+    }
+    if (h->version != CKPT_VERSION || h->headerSize != sizeof(CheckpointHeader) || h->fileSize > m.size) {
+        fprintf(stderr, "checkpoint: %s has unsupported version %u\n", path, h->version); unmapCheckpoint(m); return false;
+    }
+    for (int c = 0; c < CKPT_NUM_COLUMNS; ++c) {
+        if (h->offset[c] % CKPT_ALIGN != 0 || h->offset[c] + ckptColumnBytes(*h, c) > h->fileSize) {
+            fprintf(stderr, "checkpoint: %s is truncated or corrupt\n", path); unmapCheckpoint(m); return false;
+        }
+    }
+    const char* b = (const char*)m.base;
+    CheckpointView& v = m.view;
+    v.header = h;
+    v.carX = (const float*)(b + h->offset[CKPT_CAR_X]);
+    v.carY = (const float*)(b + h->offset[CKPT_CAR_Y]);
+    v.carSpeed = (const float*)(b + h->offset[CKPT_CAR_SPEED]);
+    v.rewardX = (const float*)(b + h->offset[CKPT_REWARD_X]);
+    v.rewardY = (const float*)(b + h->offset[CKPT_REWARD_Y]);
+    v.rewardCollected = (const uint8_t*)(b + h->offset[CKPT_REWARD_COLLECTED]);
+    v.trailX = (const float*)(b + h->offset[CKPT_TRAIL_X]);
+    v.trailY = (const float*)(b + h->offset[CKPT_TRAIL_Y]);
+    v.laneCenters = (const float*)(b + h->offset[CKPT_LANE_CENTERS]);
+    v.lineOffsets = (const float*)(b + h->offset[CKPT_LINE_OFFSETS]);
+    v.rng = b + h->offset[CKPT_RNG];
+    return true;
+}
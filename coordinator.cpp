@@ -0,0 +1,317 @@
+// coordinator.cpp - rollout-uri pe mai multe masini: workeri care tin shard-uri de
+// instante si un coordonator care le trimite actiunile si aduna rezultatele (TCP).
+// Linux: g++ -std=c++17 -O2 coordinator.cpp infiniteLanes.cpp -o coordinator -lpthread
+//
+//   coordinator worker <port> [thread-uri]                 daemon, o sesiune dupa alta
+//   coordinator run <instante/worker> <pasi> host:port...  rollout cu actiuni scriptate
+//   coordinator selftest [workeri] [instante/worker] [pasi]
+//       porneste workerii pe loopback (procese copil), verifica rezultatele bit cu bit
+//       fata de un il_env local per shard si compara debitul cu/fara pipelining
+//
+// Protocolul e in shardProtocol.h. Workerul indreapta bufferele il_env direct in
+// bufferul mesajului RESULT, iar coordonatorul primeste fiecare sectiune direct in
+// tablourile globale (la offset-ul shard-ului), deci nu exista copii intermediare.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "shardProtocol.h"
+#include "infiniteLanes.h"
+
+// ------------------------- WORKER -------------------------
+// Serveste o conexiune pana la BYE sau deconectare. Cererile urmatoare asteapta in
+// bufferul TCP cat timp se simuleaza cea curenta, deci transferul se suprapune cu pasul.
+static bool serveSession(int fd, int threads) {
+    ShardMsgHeader h;
+    ShardHello hello;
+    if (!shardRecvAll(fd, &h, sizeof(h)) || h.type != SHARD_HELLO || h.bytes != sizeof(hello) ||
+        !shardRecvAll(fd, &hello, sizeof(hello)) || hello.magic != SHARD_MAGIC || hello.version != SHARD_VERSION)
+        return false;
+
+    il_config cfg = {};
+    cfg.num_instances = hello.numInstances;
+    cfg.num_threads = hello.numThreads > 0 ? hello.numThreads : threads;
+    cfg.num_ai_cars = hello.numAiCars;
+    cfg.lanes_left = hello.lanesLeft;
+    cfg.lanes_right = hello.lanesRight;
+    cfg.auto_reset = hello.autoReset;
+    cfg.seed = hello.seed;
+    il_env* env = il_create(&cfg);
+    ShardReady ready = { SHARD_MAGIC, SHARD_VERSION, env ? il_num_instances(env) : 0, env ? il_observation_size(env) : 0 };
+    if (!shardSendMsg(fd, SHARD_READY, h.seq, &ready, sizeof(ready)) || !env) { il_destroy(env); return false; }
+
+    // RESULT = rewards | scores | observations | dones, toate in acelasi buffer
+    const int n = ready.numInstances, obsSize = ready.obsSize;
+    const bool withObs = hello.sendObservations != 0;
+    const uint32_t resultBytes = (uint32_t)shardResultBytes(n, obsSize, withObs);
+    std::vector<char> result(resultBytes);
+    std::vector<float> unsentObs(withObs ? 0 : (size_t)n * obsSize);  // il_env le scrie oricum
+    std::vector<uint8_t> actions(n);
+    il_buffers b = {};
+    b.actions = actions.data();
+    b.rewards = (float*)result.data();
+    b.scores = (int32_t*)(result.data() + (size_t)n * 4);
+    b.observations = withObs ? (float*)(result.data() + (size_t)n * 8) : unsentObs.data();
+    b.dones = (uint8_t*)(result.data() + (size_t)n * 8 + (withObs ? (size_t)n * obsSize * 4 : 0));
+    il_set_buffers(env, &b);
+
+    bool ok = true;
+    while (ok && shardRecvAll(fd, &h, sizeof(h))) {
+        if (h.type == SHARD_BYE) break;
+        if (h.type == SHARD_STEP && h.bytes == (uint32_t)n && shardRecvAll(fd, actions.data(), n)) il_step(env);
+        else if (h.type == SHARD_RESET && h.bytes == 0) il_reset(env);
+        else { ok = false; break; }
+        ok = shardSendMsg(fd, SHARD_RESULT, h.seq, result.data(), resultBytes);
+    }
+    il_destroy(env);
+    return ok;
+}
+
+static int runWorker(uint16_t port, int threads, int listenFd, int sessions) {
+    int lfd = listenFd >= 0 ? listenFd : shardListen(port, &port);
+    if (lfd < 0) { perror("coordinator: listen"); return 1; }
+    if (listenFd < 0) printf("worker listening on port %u\n", port);
+    for (int s = 0; sessions <= 0 || s < sessions; ++s) {
+        int fd = accept(lfd, nullptr, nullptr);
+        if (fd < 0) { if (errno == EINTR) continue; perror("coordinator: accept"); break; }
+        shardNoDelay(fd);
+        serveSession(fd, threads);
+        close(fd);
+    }
+    close(lfd);
+    return 0;
+}
+
+// ------------------------- COORDINATOR -------------------------
+struct ShardCoordinator {
+    struct Worker {
+        int fd = -1;
+        int begin = 0, count = 0;
+        uint32_t nextReq = 0, nextResp = 0;
+    };
+    std::vector<Worker> workers;
+    int numInstances = 0, obsSize = 0;
+    bool withObs = false;
+    // rezultatele ultimului collect(), pentru toate instantele
+    std::vector<float> rewards, observations;
+    std::vector<int32_t> scores;
+    std::vector<uint8_t> dones;
+
+    // Cate un shard de perWorker instante pe fiecare adresa; shard-ul w are seed + w.
+    bool connect(const std::vector<std::string>& addrs, int perWorker, const ShardHello& base) {
+        for (size_t w = 0; w < addrs.size(); ++w) {
+            Worker wk;
+            wk.fd = shardConnect(addrs[w].c_str());
+            if (wk.fd < 0) { fprintf(stderr, "coordinator: cannot connect to %s\n", addrs[w].c_str()); return false; }
+            ShardHello hello = base;
+            hello.magic = SHARD_MAGIC;
+            hello.version = SHARD_VERSION;
+            hello.numInstances = perWorker;
+            hello.seed = base.seed + w;
+            ShardMsgHeader h;
+            ShardReady ready;
+            if (!shardSendMsg(wk.fd, SHARD_HELLO, 0, &hello, sizeof(hello)) ||
+                !shardRecvAll(wk.fd, &h, sizeof(h)) || h.type != SHARD_READY || h.bytes != sizeof(ready) ||
+                !shardRecvAll(wk.fd, &ready, sizeof(ready)) || ready.numInstances != perWorker) {
+                fprintf(stderr, "coordinator: handshake with %s failed\n", addrs[w].c_str());
+                ::close(wk.fd);
+                return false;
+            }
+            wk.begin = numInstances;
+            wk.count = perWorker;
+            numInstances += perWorker;
+            obsSize = ready.obsSize;
+            workers.push_back(wk);
+        }
+        withObs = base.sendObservations != 0;
+        rewards.assign(numInstances, 0.0f);
+        scores.assign(numInstances, 0);
+        dones.assign(numInstances, 0);
+        if (withObs) observations.assign((size_t)numInstances * obsSize, 0.0f);
+        return true;
+    }
+
+    int inFlight() const { return workers.empty() ? 0 : (int)(workers[0].nextReq - workers[0].nextResp); }
+
+    // Trimite un pas (actions[numInstances]) tuturor workerilor, fara sa astepte.
+    bool submitStep(const uint8_t* actions) {
+        for (Worker& w : workers)
+            if (!shardSendMsg(w.fd, SHARD_STEP, w.nextReq++, actions + w.begin, (uint32_t)w.count)) return false;
+        return true;
+    }
+
+    bool submitReset() {
+        for (Worker& w : workers)
+            if (!shardSendMsg(w.fd, SHARD_RESET, w.nextReq++, nullptr, 0)) return false;
+        return true;
+    }
+
+    // Primeste cel mai vechi raspuns de la fiecare worker direct in tablourile globale.
+    bool collect() {
+        for (Worker& w : workers) {
+            ShardMsgHeader h;
+            const size_t n = (size_t)w.count;
+            if (!shardRecvAll(w.fd, &h, sizeof(h)) || h.type != SHARD_RESULT || h.seq != w.nextResp ||
+                h.bytes != shardResultBytes(w.count, obsSize, withObs))
+                return false;
+            ++w.nextResp;
+            if (!shardRecvAll(w.fd, rewards.data() + w.begin, n * sizeof(float)) ||
+                !shardRecvAll(w.fd, scores.data() + w.begin, n * sizeof(int32_t)) ||
+                (withObs && !shardRecvAll(w.fd, observations.data() + (size_t)w.begin * obsSize, n * obsSize * sizeof(float))) ||
+                !shardRecvAll(w.fd, dones.data() + w.begin, n))
+                return false;
+        }
+        return true;
+    }
+
+    bool step(const uint8_t* actions) { return submitStep(actions) && collect(); }
+
+    void close() {
+        for (Worker& w : workers) {
+            shardSendMsg(w.fd, SHARD_BYE, w.nextReq, nullptr, 0);
+            ::close(w.fd);
+        }
+        workers.clear();
+    }
+};
+
+// Actiuni deterministe, la fel pe coordonator si in referinta locala.
+static uint8_t scriptedAction(int step, int instance) {
+    uint32_t h = (uint32_t)step * 2654435761u ^ (uint32_t)instance * 40503u;
+    h ^= h >> 13;
+    return (uint8_t)((h >> 3) & 15);
+}
+
+static void fillActions(std::vector<uint8_t>& a, int step) {
+    for (size_t i = 0; i < a.size(); ++i) a[i] = scriptedAction(step, (int)i);
+}
+
+// Pasi cu `depth` cereri in zbor (actiuni scriptate, nu depind de observatii).
+static double timedRun(ShardCoordinator& c, int steps, int depth) {
+    std::vector<uint8_t> actions(c.numInstances);
+    auto t0 = std::chrono::steady_clock::now();
+    int sent = 0, done = 0;
+    while (done < steps) {
+        while (sent < steps && c.inFlight() < depth) {
+            fillActions(actions, sent++);
+            if (!c.submitStep(actions.data())) return -1.0;
+        }
+        if (!c.collect()) return -1.0;
+        ++done;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static int runCoordinator(int perWorker, int steps, const std::vector<std::string>& addrs) {
+    ShardCoordinator c;
+    ShardHello base = {};
+    base.autoReset = 1;
+    base.seed = 1;
+    if (!c.connect(addrs, perWorker, base)) return 1;
+    for (int depth : { 1, 4 }) {
+        double sec = timedRun(c, steps, depth);
+        if (sec < 0) { fprintf(stderr, "coordinator: connection lost\n"); c.close(); return 1; }
+        printf("%zu workers x %d instances, depth %d: %.0f steps/s (%.2f M game-steps/s)\n",
+               c.workers.size(), perWorker, depth, steps / sec, steps * (double)c.numInstances / sec / 1e6);
+    }
+    c.close();
+    return 0;
+}
+
+static int selftest(int numWorkers, int perWorker, int steps) {
+    std::vector<std::string> addrs;
+    std::vector<pid_t> children;
+    for (int w = 0; w < numWorkers; ++w) {
+        uint16_t port = 0;
+        int lfd = shardListen(0, &port);
+        if (lfd < 0) { perror("coordinator: listen"); return 1; }
+        pid_t pid = fork();
+        if (pid == 0) _exit(runWorker(port, 1, lfd, 1));
+        close(lfd);
+        children.push_back(pid);
+        addrs.push_back("127.0.0.1:" + std::to_string(port));
+    }
+
+    ShardHello base = {};
+    base.autoReset = 1;
+    base.sendObservations = 1;
+    base.seed = 7;
+    ShardCoordinator c;
+    bool ok = c.connect(addrs, perWorker, base);
+
+    // referinta: aceleasi shard-uri simulate local
+    std::vector<il_env*> refs;
+    for (int w = 0; ok && w < numWorkers; ++w) {
+        il_config cfg = {};
+        cfg.num_instances = perWorker;
+        cfg.auto_reset = 1;
+        cfg.seed = base.seed + w;
+        refs.push_back(il_create(&cfg));
+    }
+
+    int mismatches = 0;
+    std::vector<uint8_t> actions(c.numInstances);
+    for (int s = 0; ok && s < steps; ++s) {
+        fillActions(actions, s);
+        // pipelining: urmatorul pas pleaca inainte sa vina rezultatul curent
+        if (s == 0 && !(ok = c.submitStep(actions.data()))) break;
+        if (s + 1 < steps) {
+            std::vector<uint8_t> next(c.numInstances);
+            fillActions(next, s + 1);
+            if (!(ok = c.submitStep(next.data()))) break;
+        }
+        if (!(ok = c.collect())) break;
+        for (int w = 0; w < numWorkers; ++w) {
+            il_buffers b;
+            il_get_buffers(refs[w], &b);
+            memcpy(b.actions, actions.data() + w * perWorker, perWorker);
+            il_step(refs[w]);
+            const size_t o = (size_t)w * perWorker;
+            if (memcmp(b.rewards, &c.rewards[o], perWorker * sizeof(float)) != 0 ||
+                memcmp(b.scores, &c.scores[o], perWorker * sizeof(int32_t)) != 0 ||
+                memcmp(b.dones, &c.dones[o], perWorker) != 0 ||
+                memcmp(b.observations, &c.observations[o * c.obsSize], (size_t)perWorker * c.obsSize * sizeof(float)) != 0)
+                ++mismatches;
+        }
+    }
+    for (il_env* r : refs) il_destroy(r);
+    if (ok) printf("selftest: %d workers x %d instances, %d steps, %d mismatching shard-steps\n",
+                   numWorkers, perWorker, steps, mismatches);
+    else fprintf(stderr, "selftest: connection failed\n");
+    c.close();
+
+    // debitul, fara observatii (mesaje compacte)
+    if (ok && mismatches == 0) {
+        for (int w = 0; w < numWorkers; ++w) {
+            uint16_t port = 0;
+            int lfd = shardListen(0, &port);
+            pid_t pid = fork();
+            if (pid == 0) _exit(runWorker(port, 1, lfd, 1));
+            close(lfd);
+            children.push_back(pid);
+            addrs[w] = "127.0.0.1:" + std::to_string(port);
+        }
+        runCoordinator(perWorker, steps, addrs);
+    }
+    for (pid_t p : children) waitpid(p, nullptr, 0);
+    return ok && mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    signal(SIGPIPE, SIG_IGN);
+    if (argc > 2 && strcmp(argv[1], "worker") == 0)
+        return runWorker((uint16_t)atoi(argv[2]), argc > 3 ? atoi(argv[3]) : 1, -1, 0);
+    if (argc > 4 && strcmp(argv[1], "run") == 0)
+        return runCoordinator(atoi(argv[2]), atoi(argv[3]), std::vector<std::string>(argv + 4, argv + argc));
+    if (argc > 1 && strcmp(argv[1], "selftest") == 0)
+        return selftest(argc > 2 ? atoi(argv[2]) : 3, argc > 3 ? atoi(argv[3]) : 64, argc > 4 ? atoi(argv[4]) : 2000);
+    fprintf(stderr, "usage: %s worker <port> [threads] | run <instances/worker> <steps> host:port... | selftest [workers] [instances/worker] [steps]\n", argv[0]);
+    return 2;
+}
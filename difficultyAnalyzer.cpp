@@ -0,0 +1,215 @@
+// difficultyAnalyzer.cpp - baleiaza parametrii de dificultate fara fereastra
+// Build: g++ -std=c++17 -O2 difficultyAnalyzer.cpp -o difficultyAnalyzer -lpthread
+//
+// Pentru fiecare combinatie din grila (NUM_AI_CARS, AI_SPEED, AI_SPAWN_AHEAD_MIN/MAX,
+// curba spawnProb) ruleaza episoade cu o politica scriptata sau aleatoare pe un
+// BatchEnv impartit cu RolloutPool si raporteaza distributia timpului de supravietuire
+// si a scorului (medie cu interval de incredere 95%, percentile).
+//
+//   difficultyAnalyzer [--cars 30,50,80] [--speed 0.006,0.008,0.012] [--ahead 1.5:3,2:4,3:6]
+//                      [--spawn-scale 3,6,12] [--spawn-base 0.002] [--spawn-max 0.15]
+//                      [--policy random|up|weave] [--episodes 2000] [--instances 1024]
+//                      [--threads N] [--max-ticks 20000] [--csv out.csv]
+//
+// Fiecare instanta contribuie acelasi numar de episoade (episodes / instances), ca
+// episoadele scurte sa nu fie supra-reprezentate. Episoadele care ating --max-ticks
+// sunt oprite si numarate ca supravietuite (coloana capped).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batchEnv.h"
+#include "rolloutPool.h"
+
+enum Policy { POLICY_RANDOM, POLICY_UP, POLICY_WEAVE };
+
+struct Setting {
+    int cars;
+    float speed, aheadMin, aheadMax, spawnScale;
+};
+
+struct Summary {
+    double mean, ci95, p10, p50, p90;
+};
+
+struct SettingResult {
+    Setting s;
+    int episodes, capped;
+    Summary survival, score;
+    double seconds;
+};
+
+static Summary summarize(std::vector<double>& v) {
+    Summary r = {};
+    if (v.empty()) return r;
+    std::sort(v.begin(), v.end());
+    double sum = 0.0, sq = 0.0;
+    for (double x : v) sum += x;
+    r.mean = sum / v.size();
+    for (double x : v) sq += (x - r.mean) * (x - r.mean);
+    double sd = v.size() > 1 ? sqrt(sq / (v.size() - 1)) : 0.0;
+    r.ci95 = 1.96 * sd / sqrt((double)v.size());
+    auto pct = [&](double p) { return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))]; };
+    r.p10 = pct(0.10); r.p50 = pct(0.50); r.p90 = pct(0.90);
+    return r;
+}
+
+// Actiunile scriptate; random = nullptr (fluxul RNG al fiecarui worker din RolloutPool).
+static const uint8_t* policyActions(Policy p, int tick, std::vector<uint8_t>& buf) {
+    if (p == POLICY_RANDOM) return nullptr;
+    for (size_t i = 0; i < buf.size(); ++i) {
+        uint8_t a = ACT_UP;
+        // weave: schimba banda periodic, cu faza diferita pe instanta
+        if (p == POLICY_WEAVE) a |= ((tick + (int)i * 37) / 60) % 2 ? ACT_LEFT : ACT_RIGHT;
+        buf[i] = a;
+    }
+    return buf.data();
+}
+
+static SettingResult runSetting(const Setting& s, const BatchConfig& base, Policy policy,
+                                int episodes, int instances, int threads, int maxTicks, uint64_t seed) {
+    BatchConfig cfg = base;
+    cfg.numAiCars = s.cars;
+    cfg.aiSpeed = s.speed;
+    cfg.aiSpawnAheadMin = s.aheadMin;
+    cfg.aiSpawnAheadMax = s.aheadMax;
+    cfg.spawnProbSpeedScale = s.spawnScale;
+
+    const int perInstance = std::max(1, (episodes + instances - 1) / instances);
+    BatchEnv env;
+    env.init(cfg, instances, seed);
+    RolloutPool pool;
+    pool.start(env, threads, seed ^ 0x5eed);
+
+    std::vector<uint8_t> actions(instances), done(instances);
+    std::vector<float> reward(instances);
+    std::vector<int32_t> score(instances);
+    std::vector<int> length(instances, 0), finished(instances, 0);
+    std::vector<double> survival, scores;
+    survival.reserve((size_t)perInstance * instances);
+    scores.reserve((size_t)perInstance * instances);
+    int remaining = instances, capped = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int tick = 0; remaining > 0; ++tick) {
+        pool.stepAll(policyActions(policy, tick, actions), reward.data(), done.data(), score.data(), true);
+        for (int i = 0; i < instances; ++i) {
+            ++length[i];
+            bool cap = !done[i] && length[i] >= maxTicks;
+            if (!done[i] && !cap) continue;
+            if (finished[i] < perInstance) {
+                survival.push_back(length[i]);
+                scores.push_back(score[i]);
+                capped += cap;
+                if (++finished[i] == perInstance) --remaining;
+            }
+            if (cap) env.reset(i);
+            length[i] = 0;
+        }
+    }
+    pool.stop();
+
+    SettingResult r;
+    r.s = s;
+    r.episodes = (int)survival.size();
+    r.capped = capped;
+    r.survival = summarize(survival);
+    r.score = summarize(scores);
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+static std::vector<float> parseList(const char* s) {
+    std::vector<float> v;
+    for (const char* p = s; *p;) {
+        char* end;
+        v.push_back(strtof(p, &end));
+        if (end == p) break;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return v;
+}
+
+// "min:max,min:max"
+static std::vector<std::pair<float, float>> parseRanges(const char* s) {
+    std::vector<std::pair<float, float>> v;
+    for (const char* p = s; *p;) {
+        char* end;
+        float a = strtof(p, &end);
+        if (end == p || *end != ':') break;
+        float b = strtof(end + 1, &end);
+        v.push_back({ a, b });
+        p = *end == ',' ? end + 1 : end;
+    }
+    return v;
+}
+
+int main(int argc, char** argv) {
+    std::vector<float> cars = { 30, 50, 80 }, speeds = { 0.006f, 0.008f, 0.012f }, scales = { 3, 6, 12 };
+    std::vector<std::pair<float, float>> ahead = { { 1.5f, 3.0f }, { 2.0f, 4.0f }, { 3.0f, 6.0f } };
+    BatchConfig base;
+    Policy policy = POLICY_RANDOM;
+    int episodes = 2000, instances = 1024, maxTicks = 20000;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const char* csvPath = nullptr;
+
+    for (int a = 1; a + 1 < argc; a += 2) {
+        const char* k = argv[a];
+        const char* v = argv[a + 1];
+        if (!strcmp(k, "--cars")) cars = parseList(v);
+        else if (!strcmp(k, "--speed")) speeds = parseList(v);
+        else if (!strcmp(k, "--ahead")) ahead = parseRanges(v);
+        else if (!strcmp(k, "--spawn-scale")) scales = parseList(v);
+        else if (!strcmp(k, "--spawn-base")) base.spawnProbBase = strtof(v, nullptr);
+        else if (!strcmp(k, "--spawn-max")) base.spawnProbMax = strtof(v, nullptr);
+        else if (!strcmp(k, "--policy")) policy = !strcmp(v, "up") ? POLICY_UP : !strcmp(v, "weave") ? POLICY_WEAVE : POLICY_RANDOM;
+        else if (!strcmp(k, "--episodes")) episodes = atoi(v);
+        else if (!strcmp(k, "--instances")) instances = atoi(v);
+        else if (!strcmp(k, "--threads")) threads = atoi(v);
+        else if (!strcmp(k, "--max-ticks")) maxTicks = atoi(v);
+        else if (!strcmp(k, "--csv")) csvPath = v;
+        else { fprintf(stderr, "unknown option %s\n", k); return 2; }
+    }
+    if (cars.empty() || speeds.empty() || ahead.empty() || scales.empty() || instances < 1 || episodes < 1 || maxTicks < 1) {
+        fprintf(stderr, "empty grid or invalid counts\n");
+        return 2;
+    }
+
+    FILE* csv = csvPath ? fopen(csvPath, "w") : nullptr;
+    if (csvPath && !csv) { fprintf(stderr, "cannot open %s\n", csvPath); return 1; }
+    if (csv) fprintf(csv, "cars,ai_speed,ahead_min,ahead_max,spawn_scale,episodes,capped,"
+                          "survival_mean,survival_ci95,survival_p10,survival_p50,survival_p90,"
+                          "score_mean,score_ci95,score_p10,score_p50,score_p90\n");
+    printf("%5s %7s %11s %6s | %6s %6s | %-22s %6s | %-18s %5s\n",
+           "cars", "speed", "ahead", "scale", "eps", "capped", "survival mean+-ci95", "p50", "score mean+-ci95", "p90");
+
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t seed = 1;
+    for (float c : cars) for (float sp : speeds) for (auto& ah : ahead) for (float sc : scales) {
+        Setting s = { (int)c, sp, ah.first, ah.second, sc };
+        SettingResult r = runSetting(s, base, policy, episodes, instances, threads, maxTicks, seed++);
+        char surv[32], scr[32], ahs[16];
+        snprintf(surv, sizeof(surv), "%.0f +- %.0f", r.survival.mean, r.survival.ci95);
+        snprintf(scr, sizeof(scr), "%.2f +- %.2f", r.score.mean, r.score.ci95);
+        snprintf(ahs, sizeof(ahs), "%.1f-%.1f", s.aheadMin, s.aheadMax);
+        printf("%5d %7.4f %11s %6.1f | %6d %6d | %-22s %6.0f | %-18s %5.0f\n",
+               s.cars, s.speed, ahs, s.spawnScale, r.episodes, r.capped, surv, r.survival.p50, scr, r.score.p90);
+        fflush(stdout);
+        if (csv) fprintf(csv, "%d,%g,%g,%g,%g,%d,%d,%.3f,%.3f,%g,%g,%g,%.4f,%.4f,%g,%g,%g\n",
+                         s.cars, s.speed, s.aheadMin, s.aheadMax, s.spawnScale, r.episodes, r.capped,
+                         r.survival.mean, r.survival.ci95, r.survival.p10, r.survival.p50, r.survival.p90,
+                         r.score.mean, r.score.ci95, r.score.p10, r.score.p50, r.score.p90);
+    }
+    if (csv) fclose(csv);
+    printf("grid done in %.1f s (%d threads)\n",
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(), threads);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// envServer.cpp - server de jocuri pentru clienti din alte procese, prin memorie partajata
+// Linux: g++ -std=c++17 -O2 envServer.cpp infiniteLanes.cpp -o envServer -lpthread -lrt
+//
+//   envServer serve <nume> [instante] [thread-uri]   ruleaza pana cand clientul cere oprirea
+//   envServer bench [instante] [iteratii]            porneste un server intr-un proces copil si
+//                                                    masoara latenta/debitul dus-intors
+//
+// Layout-ul si protocolul sunt in envShm.h; calea de date nu trece prin socket-uri
+// si nu serializeaza nimic: serverul paseaza direct bufferele slotului lui il_step().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <vector>
+
+#include "envShm.h"
+#include "infiniteLanes.h"
+
+static int serve(const char* name, int instances, int threads) {
+    il_config cfg = {};
+    cfg.num_instances = instances;
+    cfg.num_threads = threads;
+    cfg.auto_reset = 1;
+    cfg.seed = 1;
+    il_env* env = il_create(&cfg);
+    if (!env) { fprintf(stderr, "envServer: il_create failed\n"); return 1; }
+    const int obsSize = il_observation_size(env);
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) { perror("envServer: shm_open"); il_destroy(env); return 1; }
+    const uint64_t total = envShmTotalBytes(instances, obsSize);
+    if (ftruncate(fd, (off_t)total) != 0) { perror("envServer: ftruncate"); close(fd); shm_unlink(name); il_destroy(env); return 1; }
+    void* mem = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) { perror("envServer: mmap"); shm_unlink(name); il_destroy(env); return 1; }
+
+    EnvShmHeader* h = new (mem) EnvShmHeader();
+    h->magic = ENV_SHM_MAGIC;
+    h->version = ENV_SHM_VERSION;
+    h->numInstances = instances;
+    h->obsSize = obsSize;
+    h->slotBytes = envShmSlotBytes(instances, obsSize);
+    h->slotsOffset = envShmAlign(sizeof(EnvShmHeader));
+
+    // starea initiala (observatiile dupa reset) in toate sloturile
+    il_buffers own;
+    il_get_buffers(env, &own);
+    for (uint32_t s = 0; s < ENV_SHM_SLOTS; ++s)
+        memcpy(envShmSlot(h, s).observations, own.observations, (size_t)instances * obsSize * sizeof(float));
+    h->serverReady.store(1, std::memory_order_release);
+
+    uint32_t next = 0;
+    for (;;) {
+        uint32_t req = h->reqSeq.load(std::memory_order_acquire);
+        while (req != next) {
+            EnvShmSlotView v = envShmSlot(h, next);
+            il_buffers b = { v.actions, v.observations, v.rewards, v.dones, v.scores };
+            il_set_buffers(env, &b);
+            if (v.slot->op == ENV_OP_RESET) il_reset(env);
+            else il_step(env);
+            ++next;
+            h->respSeq.store(next, std::memory_order_release);
+            envFutexWake(&h->respSeq);
+        }
+        if (h->shutdown.load(std::memory_order_acquire)) break;
+        envFutexWaitChange(&h->reqSeq, next, &h->shutdown);
+    }
+
+    munmap(mem, total);
+    shm_unlink(name);
+    il_destroy(env);
+    return 0;
+}
+
+static int bench(int instances, int iters) {
+    char name[64];
+    snprintf(name, sizeof(name), "/infinitelanes-bench-%d", (int)getpid());
+    pid_t child = fork();
+    if (child < 0) { perror("envServer: fork"); return 1; }
+    if (child == 0) _exit(serve(name, instances, 1));
+
+    EnvShmClient c;
+    for (int tries = 0; !c.connect(name); ++tries) {
+        if (tries > 2000) { fprintf(stderr, "envServer: server did not start\n"); kill(child, SIGTERM); return 1; }
+        usleep(1000);
+    }
+
+    // latenta: o cerere in zbor
+    std::vector<double> lat;
+    lat.reserve(iters);
+    EnvShmSlotView v;
+    for (int i = 0; i < iters; ++i) {
+        EnvShmSlotView s = c.nextSlot();
+        memset(s.actions, IL_ACT_UP, (size_t)instances);
+        auto t0 = std::chrono::steady_clock::now();
+        c.submit(ENV_OP_STEP);
+        if (!c.wait(v)) break;
+        lat.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+    }
+    std::sort(lat.begin(), lat.end());
+
+    // debit: inelul plin (ENV_SHM_SLOTS cereri in zbor)
+    auto t0 = std::chrono::steady_clock::now();
+    int sent = 0, received = 0;
+    while (received < iters) {
+        while (sent < iters && c.inFlight() < ENV_SHM_SLOTS) {
+            memset(c.nextSlot().actions, IL_ACT_UP, (size_t)instances);
+            c.submit(ENV_OP_STEP);
+            ++sent;
+        }
+        if (!c.wait(v)) break;
+        ++received;
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    c.requestShutdown();
+    c.disconnect();
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    if (!lat.empty())
+        printf("%d instances: round trip p50 %.1f us, p99 %.1f us; pipelined %.0f batch steps/s (%.2f M game-steps/s)\n",
+               instances, lat[lat.size() / 2], lat[lat.size() * 99 / 100], received / sec, received * (double)instances / sec / 1e6);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "serve") == 0)
+        return serve(argv[2], argc > 3 ? atoi(argv[3]) : 1, argc > 4 ? atoi(argv[4]) : 1);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        return bench(argc > 2 ? atoi(argv[2]) : 64, argc > 3 ? atoi(argv[3]) : 10000);
+    fprintf(stderr, "usage: %s serve <name> [instances] [threads] | bench [instances] [iterations]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,182 @@
+// envShm.h - layout-ul memoriei partajate dintre envServer si clienti (POSIX/Linux)
+// Header-only. Clientul are nevoie doar de acest fisier (plus -lrt pe glibc vechi).
+//
+// Un segment /dev/shm/<nume> contine un header si un inel de ENV_SHM_SLOTS sloturi.
+// Fiecare slot are buffere pentru actiuni, observatii, recompense, done si
+// scoruri ale tuturor instantelor; serverul scrie rezultatele direct acolo
+// (il_set_buffers), nimic nu se serializeaza sau copiaza.
+//
+// Protocol (un singur client per segment):
+//   - clientul completeaza actiunile slotului (reqSeq % ENV_SHM_SLOTS), seteaza op,
+//     apoi incrementeaza reqSeq si trezeste serverul (futex pe reqSeq);
+//   - serverul proceseaza cererile in ordine, apoi incrementeaza respSeq si
+//     trezeste clientul (futex pe respSeq).
+// Clientul poate avea pana la ENV_SHM_SLOTS cereri in zbor; submit() refuza una in plus.
+// Rezultatele intoarse de wait() stau in slotul cererii, care e refolosit de a
+// ENV_SHM_SLOTS-a cerere de dupa ea: raman valide inca ENV_SHM_SLOTS - 1 - inFlight()
+// apeluri submit() (cu inelul plin, chiar urmatorul submit() le suprascrie).
+#pragma once
+
+#ifdef _WIN32
+#error "envShm.h uses POSIX shared memory and Linux futexes"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define ENV_SHM_MAGIC 0x494c5348u  // "ILSH"
+#define ENV_SHM_VERSION 1
+#define ENV_SHM_SLOTS 4
+
+enum EnvShmOp : uint32_t { ENV_OP_STEP = 1, ENV_OP_RESET = 2 };
+
+struct EnvShmHeader {
+    uint32_t magic, version;
+    int32_t numInstances, obsSize;
+    uint64_t slotBytes;      // marimea unui slot (aliniata la 64)
+    uint64_t slotsOffset;    // de unde incep sloturile
+    alignas(64) std::atomic<uint32_t> reqSeq;   // scris de client
+    alignas(64) std::atomic<uint32_t> respSeq;  // scris de server
+    alignas(64) std::atomic<uint32_t> shutdown;
+    std::atomic<uint32_t> serverReady;
+};
+
+// Inceputul fiecarui slot; dupa el vin bufferele, fiecare aliniat la 64.
+struct EnvShmSlot {
+    uint32_t op;
+    uint32_t pad[15];
+};
+
+struct EnvShmSlotView {
+    EnvShmSlot* slot;
+    uint8_t* actions;
+    float* observations;
+    float* rewards;
+    uint8_t* dones;
+    int32_t* scores;
+};
+
+inline uint64_t envShmAlign(uint64_t v) { return (v + 63) & ~(uint64_t)63; }
+
+inline uint64_t envShmSlotBytes(int n, int obsSize) {
+    uint64_t b = envShmAlign(sizeof(EnvShmSlot));
+    b += envShmAlign((uint64_t)n);                                  // actions
+    b += envShmAlign((uint64_t)n * obsSize * sizeof(float));        // observations
+    b += envShmAlign((uint64_t)n * sizeof(float));                  // rewards
+    b += envShmAlign((uint64_t)n);                                  // dones
+    b += envShmAlign((uint64_t)n * sizeof(int32_t));                // scores
+    return b;
+}
+
+inline uint64_t envShmTotalBytes(int n, int obsSize) {
+    return envShmAlign(sizeof(EnvShmHeader)) + ENV_SHM_SLOTS * envShmSlotBytes(n, obsSize);
+}
+
+inline EnvShmSlotView envShmSlot(EnvShmHeader* h, uint32_t index) {
+    char* p = (char*)h + h->slotsOffset + (uint64_t)(index % ENV_SHM_SLOTS) * h->slotBytes;
+    const uint64_t n = (uint64_t)h->numInstances;
+    EnvShmSlotView v;
+    v.slot = (EnvShmSlot*)p; p += envShmAlign(sizeof(EnvShmSlot));
+    v.actions = (uint8_t*)p; p += envShmAlign(n);
+    v.observations = (float*)p; p += envShmAlign(n * h->obsSize * sizeof(float));
+    v.rewards = (float*)p; p += envShmAlign(n * sizeof(float));
+    v.dones = (uint8_t*)p; p += envShmAlign(n);
+    v.scores = (int32_t*)p;
+    return v;
+}
+
+// ------------------------- FUTEX -------------------------
+// Fara FUTEX_PRIVATE_FLAG: cuvantul e in memorie partajata intre procese.
+inline void envFutexWake(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+// Asteapta pana cand *word != seen; intai cateva rotiri (latenta mica), apoi
+// futex cu timeout ca sa putem verifica si shutdown.
+inline uint32_t envFutexWaitChange(std::atomic<uint32_t>* word, uint32_t seen, const std::atomic<uint32_t>* shutdown) {
+    for (int spin = 0; spin < 2000; ++spin) {
+        uint32_t v = word->load(std::memory_order_acquire);
+        if (v != seen) return v;
+    }
+    for (;;) {
+        uint32_t v = word->load(std::memory_order_acquire);
+        if (v != seen) return v;
+        if (shutdown && shutdown->load(std::memory_order_acquire)) return v;
+        struct timespec ts = { 0, 50 * 1000 * 1000 };
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, seen, &ts, nullptr, 0);
+    }
+}
+
+// ------------------------- CLIENT -------------------------
+struct EnvShmClient {
+    EnvShmHeader* header = nullptr;
+    size_t size = 0;
+    uint32_t nextReq = 0;   // urmatoarea cerere de trimis
+    uint32_t nextResp = 0;  // urmatorul raspuns asteptat
+
+    bool connect(const char* name) {
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EnvShmHeader)) { close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        EnvShmHeader* h = (EnvShmHeader*)p;
+        if (h->magic != ENV_SHM_MAGIC || h->version != ENV_SHM_VERSION || !h->serverReady.load(std::memory_order_acquire)) {
+            munmap(p, (size_t)st.st_size);
+            return false;
+        }
+        header = h; size = (size_t)st.st_size;
+        nextReq = nextResp = h->reqSeq.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void disconnect() {
+        if (header) munmap(header, size);
+        header = nullptr; size = 0;
+    }
+
+    int inFlight() const { return (int)(nextReq - nextResp); }
+
+    // Slotul in care se scriu actiunile urmatoarei cereri (doar cu inFlight() < ENV_SHM_SLOTS;
+    // poate fi slotul ultimului raspuns intors de wait(), vezi mai sus).
+    EnvShmSlotView nextSlot() { return envShmSlot(header, nextReq); }
+
+    // false (si nu trimite nimic) daca inelul e plin: slotul e inca la server.
+    bool submit(EnvShmOp op) {
+        if (inFlight() >= ENV_SHM_SLOTS) return false;
+        EnvShmSlotView v = envShmSlot(header, nextReq);
+        v.slot->op = op;
+        ++nextReq;
+        header->reqSeq.store(nextReq, std::memory_order_release);
+        envFutexWake(&header->reqSeq);
+        return true;
+    }
+
+    // Asteapta cel mai vechi raspuns; false daca serverul s-a oprit intre timp.
+    bool wait(EnvShmSlotView& out) {
+        uint32_t done = header->respSeq.load(std::memory_order_acquire);
+        while ((int32_t)(done - nextResp) <= 0) {
+            if (header->shutdown.load(std::memory_order_acquire)) return false;
+            done = envFutexWaitChange(&header->respSeq, done, &header->shutdown);
+        }
+        out = envShmSlot(header, nextResp++);
+        return true;
+    }
+
+    void requestShutdown() {
+        header->shutdown.store(1, std::memory_order_release);
+        envFutexWake(&header->reqSeq);
+    }
+};
@@ -0,0 +1,127 @@
+// fastRandom.h - generator de numere aleatoare pe blocuri (xoshiro128**, 8 fluxuri in paralel)
+// Header-only, fara GL; se pune langa main.cpp.
+//
+// In loc sa construim un std::uniform_*_distribution si sa scoatem o singura
+// valoare din mt19937 la fiecare apel, umplem BLOCK valori de 32 de biti deodata.
+// Bucla din refill() lucreaza pe LANES fluxuri independente si e scrisa ca
+// compilatorul sa o vectorizeze (SSE2/AVX2); apelurile citesc apoi din bloc.
+// sizeof(BlockRng) = 656 B (fata de 5000 B pentru mt19937) si e trivial copiabil,
+// deci intra direct in GameSnapshot.
+//
+// Pentru decizii per entitate in update() exista si philox4x32(): valoarea
+// depinde doar de (seed, tick, entitate, scop), nu de ordinea extragerilor.
+// Doar extragerile sunt independente de ordine, nu si rezultatul update-ului:
+// verificarea de suprapunere la respawn citeste pozitiile masinilor deja mutate
+// in tick-ul curent, deci tick-urile cu respawn raman secventiale (vezi
+// BatchEnv::stepWorld); restul mutarii poate fi paralel/SIMD.
+#pragma once
+
+#include <stdint.h>
+
+// Conversii din 32 de biti aleatori, comune pentru BlockRng si Philox.
+inline float rngFloat01(uint32_t bits) { return (float)(bits >> 8) * (1.0f / 16777216.0f); }
+inline float rngRange(uint32_t bits, float a, float b) { return a + (b - a) * rngFloat01(bits); }
+// [a, b] inclusiv, prin multiply-shift (fara impartire)
+inline int rngInt(uint32_t bits, int a, int b) {
+    uint32_t range = (uint32_t)(b - a) + 1u;
+    return a + (int)(((uint64_t)bits * range) >> 32);
+}
+
+struct BlockRng {
+    enum { LANES = 8, BLOCK = 128 };
+
+    uint32_t s[4][LANES];   // starea xoshiro128** pe fiecare flux
+    uint32_t block[BLOCK];  // valori gata generate
+    uint32_t cursor;        // urmatoarea valoare din block (BLOCK = trebuie reumplut)
+    uint64_t draws;         // cate valori s-au consumat de la seed()
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    void seed(uint64_t seedValue) {
+        uint64_t x = seedValue;
+        for (int l = 0; l < LANES; ++l) {
+            uint64_t a = splitmix64(x), b = splitmix64(x);
+            s[0][l] = (uint32_t)a; s[1][l] = (uint32_t)(a >> 32);
+            s[2][l] = (uint32_t)b; s[3][l] = (uint32_t)(b >> 32);
+            if ((s[0][l] | s[1][l] | s[2][l] | s[3][l]) == 0) s[0][l] = 1;
+        }
+        cursor = BLOCK;
+        draws = 0;
+    }
+
+    void refill() {
+        for (int r = 0; r < BLOCK / LANES; ++r) {
+            uint32_t* out = block + r * LANES;
+            for (int l = 0; l < LANES; ++l) {
+                uint32_t x = s[1][l] * 5u;
+                out[l] = ((x << 7) | (x >> 25)) * 9u;
+                uint32_t t = s[1][l] << 9;
+                s[2][l] ^= s[0][l];
+                s[3][l] ^= s[1][l];
+                s[1][l] ^= s[2][l];
+                s[0][l] ^= s[3][l];
+                s[2][l] ^= t;
+                s[3][l] = (s[3][l] << 11) | (s[3][l] >> 21);
+            }
+        }
+        cursor = 0;
+    }
+
+    uint32_t nextU32() {
+        if (cursor == BLOCK) refill();
+        ++draws;
+        return block[cursor++];
+    }
+
+    // [0, 1) cu 24 de biti de mantisa
+    float next01() { return rngFloat01(nextU32()); }
+
+    float uniform(float a, float b) { return rngRange(nextU32(), a, b); }
+
+    int uniformInt(int a, int b) { return rngInt(nextU32(), a, b); }
+};
+
+inline BlockRng makeBlockRng(uint64_t seedValue) { BlockRng r; r.seed(seedValue); return r; }
+
+// ------------------------- PHILOX 4x32-10 -------------------------
+// RNG pe contor (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Cheia e seed-ul jocului, contorul e (tick, entitate, scop); fiecare apel
+// intoarce 4 valori independente de 32 de biti.
+struct Philox4 { uint32_t v[4]; };
+
+// Scopul extragerii; bitii de sus pot purta un sub-index (ex. incercarea de respawn).
+enum RngPurpose : uint32_t {
+    RNG_CAR_RESPAWN = 1,
+    RNG_REWARD_SPAWN = 2,
+    RNG_REWARD_ROLL = 3,
+    RNG_RESET_CAR = 4,
+    RNG_RESET_REWARD = 5,
+    RNG_START_STATE = 6,
+};
+inline uint32_t rngPurpose(RngPurpose p, uint32_t sub) { return (uint32_t)p | (sub << 8); }
+
+inline uint32_t philoxMulHi(uint32_t a, uint32_t b, uint32_t& lo) {
+    uint64_t p = (uint64_t)a * b;
+    lo = (uint32_t)p;
+    return (uint32_t)(p >> 32);
+}
+
+inline Philox4 philox4x32(uint64_t seed, uint64_t tick, uint32_t entity, uint32_t purpose) {
+    uint32_t c0 = (uint32_t)tick, c1 = entity, c2 = purpose, c3 = (uint32_t)(tick >> 32);
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+    for (int r = 0; r < 10; ++r) {
+        uint32_t lo0, lo1;
+        uint32_t hi0 = philoxMulHi(0xD2511F53u, c0, lo0);
+        uint32_t hi1 = philoxMulHi(0xCD9E8D57u, c2, lo1);
+        c0 = hi1 ^ c1 ^ k0; c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1; c3 = lo0;
+        k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+    }
+    Philox4 out = { { c0, c1, c2, c3 } };
+    return out;
+}
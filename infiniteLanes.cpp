@@ -0,0 +1,138 @@
+// infiniteLanes.cpp - implementarea API-ului C din infiniteLanes.h
+// Foloseste doar header-ele fara GL (batchEnv.h, rolloutPool.h, sensors.h).
+
+#ifndef INFINITE_LANES_BUILD
+#define INFINITE_LANES_BUILD
+#endif
+
+#include "infiniteLanes.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "batchEnv.h"
+#include "rolloutPool.h"
+#include "sensors.h"
+
+static_assert((int)IL_ACT_UP == (int)ACT_UP && (int)IL_ACT_DOWN == (int)ACT_DOWN &&
+              (int)IL_ACT_LEFT == (int)ACT_LEFT && (int)IL_ACT_RIGHT == (int)ACT_RIGHT,
+              "IL_ACT_* must match ACT_*");
+
+static void* ilAlignedAlloc(size_t bytes) {
+    if (bytes == 0) bytes = 64;
+    bytes = (bytes + 63) & ~(size_t)63;
+#ifdef _WIN32
+    void* p = _aligned_malloc(bytes, 64);
+#else
+    void* p = aligned_alloc(64, bytes);
+#endif
+    if (p) memset(p, 0, bytes);
+    return p;
+}
+
+static void ilAlignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+struct il_env {
+    BatchEnv batch;
+    RolloutPool pool;
+    SensorConfig sensors;
+    SensorScratch scratch;   // pentru il_reset*, pe thread-ul apelantului
+    int obsSize = 0;
+    bool autoReset = false;
+    il_buffers owned = {};   // alocate de biblioteca
+    il_buffers current = {}; // cele folosite de il_step
+};
+
+extern "C" {
+
+IL_API const char* il_version(void) { return "infinitelanes 1"; }
+
+IL_API il_env* il_create(const il_config* cfg) {
+    il_config c = {};
+    c.num_instances = 1;
+    if (cfg) c = *cfg;
+    if (c.num_instances < 1) return nullptr;
+
+    BatchConfig bc;
+    if (c.num_ai_cars > 0) bc.numAiCars = c.num_ai_cars;
+    if (c.lanes_left > 0) bc.laneNumLeft = c.lanes_left;
+    if (c.lanes_right > 0) bc.laneNumRight = c.lanes_right;
+
+    il_env* env = new (std::nothrow) il_env();
+    if (!env) return nullptr;
+    env->batch.init(bc, c.num_instances, c.seed);
+    env->pool.start(env->batch, c.num_threads > 1 ? c.num_threads : 1, c.seed ^ 0x5eed);
+    env->obsSize = observationSize(env->batch, env->sensors);
+    env->autoReset = c.auto_reset != 0;
+
+    size_t n = (size_t)c.num_instances;
+    env->owned.actions = (uint8_t*)ilAlignedAlloc(n);
+    env->owned.observations = (float*)ilAlignedAlloc(n * env->obsSize * sizeof(float));
+    env->owned.rewards = (float*)ilAlignedAlloc(n * sizeof(float));
+    env->owned.dones = (uint8_t*)ilAlignedAlloc(n);
+    env->owned.scores = (int32_t*)ilAlignedAlloc(n * sizeof(int32_t));
+    if (!env->owned.actions || !env->owned.observations || !env->owned.rewards || !env->owned.dones || !env->owned.scores) {
+        il_destroy(env);
+        return nullptr;
+    }
+    env->current = env->owned;
+    observeRange(env->batch, 0, c.num_instances, env->sensors, env->scratch, env->current.observations);
+    return env;
+}
+
+IL_API void il_destroy(il_env* env) {
+    if (!env) return;
+    env->pool.stop();
+    ilAlignedFree(env->owned.actions);
+    ilAlignedFree(env->owned.observations);
+    ilAlignedFree(env->owned.rewards);
+    ilAlignedFree(env->owned.dones);
+    ilAlignedFree(env->owned.scores);
+    delete env;
+}
+
+IL_API int32_t il_num_instances(const il_env* env) { return env ? env->batch.numInstances : 0; }
+
+IL_API int32_t il_observation_size(const il_env* env) { return env ? env->obsSize : 0; }
+
+IL_API void il_get_buffers(const il_env* env, il_buffers* out) {
+    if (env && out) *out = env->current;
+}
+
+IL_API void il_set_buffers(il_env* env, const il_buffers* in) {
+    if (!env || !in) return;
+    if (in->actions) env->current.actions = in->actions;
+    if (in->observations) env->current.observations = in->observations;
+    if (in->rewards) env->current.rewards = in->rewards;
+    if (in->dones) env->current.dones = in->dones;
+    if (in->scores) env->current.scores = in->scores;
+}
+
+IL_API void il_reset_instance(il_env* env, int32_t index) {
+    if (!env || index < 0 || index >= env->batch.numInstances) return;
+    env->batch.reset(index);
+    env->current.dones[index] = 0;
+    env->current.scores[index] = 0;
+    env->current.rewards[index] = 0.0f;
+    observe(env->batch, index, env->sensors, env->scratch, env->current.observations + (size_t)index * env->obsSize);
+}
+
+IL_API void il_reset(il_env* env) {
+    if (!env) return;
+    for (int i = 0; i < env->batch.numInstances; ++i) il_reset_instance(env, i);
+}
+
+IL_API void il_step(il_env* env) {
+    if (!env) return;
+    il_buffers& b = env->current;
+    env->pool.stepAll(b.actions, b.rewards, b.dones, b.scores, env->autoReset, 1, b.observations, &env->sensors);
+}
+
+} // extern "C"
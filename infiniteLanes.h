@@ -0,0 +1,82 @@
+/* infiniteLanes.h - API C pentru libinfinitelanes (simulare fara fereastra)
+ *
+ * Build (Linux):   g++ -std=c++17 -O2 -shared -fPIC infiniteLanes.cpp -o libinfinitelanes.so -lpthread
+ * Build (Windows): cl /O2 /LD /DINFINITE_LANES_BUILD infiniteLanes.cpp /Fe:infinitelanes.dll
+ *
+ * Un il_env tine N jocuri (N = 1 pentru mediul simplu). Actiunile, observatiile,
+ * recompensele, done si scorurile stau in buffere fie ale bibliotecii (aliniate
+ * la 64 de bytes, vezi il_get_buffers), fie ale apelantului (il_set_buffers).
+ * il_step() citeste si scrie direct in ele, nu se copiaza nimic la granita.
+ *
+ * Actiuni: biti IL_ACT_* (un uint8_t per instanta).
+ * Observatie: grila de ocupare 2 x benzi x distanta + distantele razelor,
+ * il_observation_size() float-uri per instanta (vezi sensors.h).
+ */
+#ifndef INFINITE_LANES_H
+#define INFINITE_LANES_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  ifdef INFINITE_LANES_BUILD
+#    define IL_API __declspec(dllexport)
+#  else
+#    define IL_API __declspec(dllimport)
+#  endif
+#else
+#  define IL_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum { IL_ACT_UP = 1, IL_ACT_DOWN = 2, IL_ACT_LEFT = 4, IL_ACT_RIGHT = 8 };
+
+typedef struct il_env il_env;
+
+typedef struct il_config {
+    int32_t num_instances;   /* 1 = mediu simplu */
+    int32_t num_threads;     /* 0 sau 1 = pe thread-ul apelantului */
+    int32_t num_ai_cars;     /* 0 = implicit (50) */
+    int32_t lanes_left;      /* 0 = implicit (18) */
+    int32_t lanes_right;     /* 0 = implicit (18) */
+    int32_t auto_reset;      /* !=0: instantele terminate pornesc un episod nou in acelasi il_step */
+    uint64_t seed;
+} il_config;
+
+typedef struct il_buffers {
+    uint8_t* actions;        /* [num_instances] */
+    float* observations;     /* [num_instances * il_observation_size()] */
+    float* rewards;          /* [num_instances] */
+    uint8_t* dones;          /* [num_instances] */
+    int32_t* scores;         /* [num_instances] */
+} il_buffers;
+
+IL_API const char* il_version(void);
+
+/* cfg poate fi NULL (o instanta, valori implicite). NULL la eroare. */
+IL_API il_env* il_create(const il_config* cfg);
+IL_API void il_destroy(il_env* env);
+
+IL_API int32_t il_num_instances(const il_env* env);
+IL_API int32_t il_observation_size(const il_env* env);
+
+/* Bufferele curente (implicit ale bibliotecii). */
+IL_API void il_get_buffers(const il_env* env, il_buffers* out);
+/* Campurile nenule inlocuiesc bufferele bibliotecii; apelantul le tine in viata
+ * pana la il_destroy sau urmatorul il_set_buffers. */
+IL_API void il_set_buffers(il_env* env, const il_buffers* in);
+
+/* Reseteaza toate instantele / una singura si scrie observatiile. */
+IL_API void il_reset(il_env* env);
+IL_API void il_reset_instance(il_env* env, int32_t index);
+
+/* Un tick pentru toate instantele cu actiunile din buffer. */
+IL_API void il_step(il_env* env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFINITE_LANES_H */
@@ -21,15 +21,31 @@
 #include <algorithm>
 #include <cmath>
 #include <string>
-#include <random> // Includere pentru Mersenne Twister
+#include <random> // random_device pentru seed
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
 
 #include <GL/glew.h>
 #include <GL/freeglut.h>
+#ifdef USE_EGL
+#include <EGL/egl.h>    // --pixel-obs fara X / fara fereastra (Linux, -DUSE_EGL -lEGL)
+#include <EGL/eglext.h>
+#endif
 
 // MODIFICARE: Am adaugat header-ul pentru shadere
 #include "loadShaders.h"    
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "checkpoint.h"
+#include "fastRandom.h"
+#include "batchEnv.h"
+#include "rolloutPool.h"
+#include "sensors.h"
+#include "trajectoryWriter.h"
+#include "textureAtlas.h"
 
 // ------------------------- CONFIG / STRUCTS -------------------------
 struct Car { float x, y; float speed; };
@@ -47,6 +63,7 @@ float carWidth = 0.1f, carHeight = 0.2f;
 bool keyStates[256] = { 0 };
 bool specialKeyStates[512] = { 0 };
 bool gameOver = false;
+uint64_t simTick = 0; // tick-uri de simulare de la pornire
 
 // --- TRAIL ---
 std::deque<std::pair<float, float>> trail;
@@ -67,48 +84,141 @@ const float dashSpeedFactor = 1.5f;
 // --- AI ---
 std::vector<Car> aiCars;
 #define NUM_AI_CARS 50
+int numAiCars = NUM_AI_CARS; // mai mare doar pentru lumile de benchmark
 #define AI_MIN_Y 0.5f
 #define AI_MAX_Y 8.0f
 #define AI_SPEED 0.008f
 #define AI_SPAWN_AHEAD_MIN 2.0f
 #define AI_SPAWN_AHEAD_MAX 4.0f
+#define MAX_AI_CARS 64
+#define MAX_REWARDS 256
+#define MAX_LANES 128
 
-// --- RANDOM (Mersenne Twister) ---
+// --- RANDOM (xoshiro pe blocuri, vezi fastRandom.h) ---
 std::random_device rd;
-std::mt19937 gen(rd());
+uint64_t rngSeed = ((uint64_t)rd() << 32) | rd();
+BlockRng gen = makeBlockRng(rngSeed); // extrageri secventiale (reset, init)
+
+// Extragere pe contor pentru deciziile din update(): aceeasi valoare indiferent
+// de ordinea in care sunt procesate entitatile (rezultatul respawn-ului insa
+// depinde de ordine, prin verificarea de suprapunere).
+inline Philox4 tickRandom(uint32_t entity, RngPurpose purpose, uint32_t sub = 0) {
+    return philox4x32(rngSeed, simTick, entity, rngPurpose(purpose, sub));
+}
+
+void seedRandom(uint64_t seed) {
+    rngSeed = seed;
+    gen.seed(seed);
+}
 
 // Am redenumit frandf
 inline float randomFloat(float a, float b) {
-    std::uniform_real_distribution<float> dis(a, b);
-    return dis(gen);
+    return gen.uniform(a, b);
 }
 
 // Am redenumit irand
 inline int randomInt(int a, int b) {
     if (a > b) std::swap(a, b);
-    std::uniform_int_distribution<int> dis(a, b);
-    return dis(gen);
+    return gen.uniformInt(a, b);
 }
 
 // --- REWARDS ---
 std::vector<Reward> rewards;
 int score = 0;
 
+// --- CAMERA ---
+float camX = 0.0f, camY = 0.0f;
+
+// ------------------------- EVENTS -------------------------
+// Simularea doar adauga evenimente tipizate intr-un ring fix (un producator,
+// un consumator); drainEvents() le distribuie ascultatorilor (HUD, log, replay,
+// telemetrie) in afara lui stepGame().
+enum GameEventType : uint8_t { EV_COIN_COLLECTED, EV_COLLISION, EV_RESPAWN, EV_RESET };
+
+struct GameEvent {
+    uint64_t tick;
+    float x, y;
+    int32_t value;   // scor dupa moneda, index masina la coliziune/respawn
+    uint8_t type;
+};
+
+#define EVENT_RING_SIZE 4096 // putere a lui 2
+
+struct EventRing {
+    GameEvent slots[EVENT_RING_SIZE];
+    alignas(64) std::atomic<uint32_t> head{ 0 }; // scris doar de producator
+    alignas(64) std::atomic<uint32_t> tail{ 0 }; // scris doar de consumator
+    uint64_t dropped = 0;
+
+    // Daca ringul e plin evenimentul se pierde (si se numara), simularea nu asteapta.
+    bool push(const GameEvent& e) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= EVENT_RING_SIZE) { ++dropped; return false; }
+        slots[h & (EVENT_RING_SIZE - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(GameEvent& e) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        e = slots[t & (EVENT_RING_SIZE - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+EventRing gameEvents;
+bool eventsEnabled = true; // oprit in rollout-uri/planificare
+
+typedef void (*EventListener)(const GameEvent& e);
+std::vector<EventListener> eventListeners;
+
+inline void emitEvent(GameEventType type, float x, float y, int32_t value) {
+    if (!eventsEnabled) return;
+    GameEvent e;
+    e.tick = simTick; e.x = x; e.y = y; e.value = value; e.type = type;
+    gameEvents.push(e);
+}
+
+void drainEvents() {
+    GameEvent e;
+    while (gameEvents.pop(e))
+        for (EventListener l : eventListeners) l(e);
+}
+
+void logEvent(const GameEvent& e) {
+    if (e.type == EV_COLLISION) std::cout << "GAME OVER!\n";
+    else if (e.type == EV_COIN_COLLECTED) std::cout << "+1 Score! Total: " << e.value << "\n";
+}
+
 // ------------------------- TEXTURES -------------------------
-GLuint carTexture = 0;
-GLuint rewardTexture = 0;
-GLuint loadTexture(const char* filename) {
+// Toate sprite-urile stau intr-un singur atlas (textureAtlas.h): loadSpriteImage()
+// doar decodeaza si adauga imaginea, uploadSpriteAtlas() impacheteaza si urca o
+// singura textura. Fiecare sprite e un dreptunghi UV in atlasTexture.
+struct SpriteRegion { float uv[4]; };
+
+TextureAtlas spriteAtlas;
+GLuint atlasTexture = 0;
+SpriteRegion carSprite, coinSprite;
+
+int loadSpriteImage(const char* filename) {
     int width = 0, height = 0, channels = 0;
     unsigned char* data = stbi_load(filename, &width, &height, &channels, 4);
-    if (!data) { std::cerr << "Failed to load texture: " << filename << std::endl; return 0; }
+    if (!data) { std::cerr << "Failed to load texture: " << filename << std::endl; return -1; }
+    int id = spriteAtlas.add(data, width, height);
+    stbi_image_free(data);
+    return id;
+}
+
+GLuint uploadSpriteAtlas() {
+    if (!spriteAtlas.build()) { std::cerr << "Sprite atlas does not fit\n"; return 0; }
     GLuint tex; glGenTextures(1, &tex); glBindTexture(GL_TEXTURE_2D, tex);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    stbi_image_free(data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spriteAtlas.width, spriteAtlas.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spriteAtlas.pixels.data());
     return tex;
 }
 
@@ -120,18 +230,173 @@ GLuint loadTexture(const char* filename) {
 // MODIFICARE: Am sters toata functia "createProgramFromStrings"
 // de aici.
 
-// ------------------------- GL OBJECTS & UNIFORMS -------------------------
-GLuint ProgramId = 0;
-GLint codColLocation = -1;
-GLint codColVertLoc = -1;
-GLint uProjLoc = -1;
-GLint uTexLoc = -1;
-GLint uColorLoc = -1;
+// Programele scenei vin din scene.vert/scene.frag: acelasi fisier, compilat cu
+// alte #define-uri, da programe specializate fara ramuri per fragment.
+inline uint64_t fnv1a(uint64_t h, const void* data, size_t n) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+std::string readTextFile(const char* path) {
+    std::string text;
+    FILE* f = fopen(path, "rb");
+    if (!f) return text;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) text.append(buf, n);
+    fclose(f);
+    return text;
+}
+
+// #define-urile trebuie sa vina dupa linia #version.
+std::string withDefines(const std::string& src, const char* defines) {
+    size_t at = src.compare(0, 8, "#version") == 0 ? src.find('\n') : std::string::npos;
+    if (at == std::string::npos) return defines + src;
+    return src.substr(0, at + 1) + defines + src.substr(at + 1);
+}
+
+GLuint compileShader(GLenum type, const std::string& src, const char* name) {
+    GLuint sh = glCreateShader(type);
+    const char* p = src.c_str();
+    glShaderSource(sh, 1, &p, nullptr);
+    glCompileShader(sh);
+    GLint ok = 0;
+    glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[2048];
+        glGetShaderInfoLog(sh, sizeof(log), nullptr, log);
+        std::cerr << "Shader " << name << " failed:\n" << log << std::endl;
+        glDeleteShader(sh);
+        return 0;
+    }
+    return sh;
+}
+
+// Cache de binare: programul linkat se salveaza cu glGetProgramBinary in
+// shadercache_<hash>.bin, hash peste sursele finale (cu #define-uri) si
+// GL_VENDOR/GL_RENDERER/GL_VERSION. La pornire se incearca glProgramBinary;
+// daca driverul il refuza (alt driver, alt build) se compileaza din sursa si
+// fisierul se rescrie. Scrierea trece printr-un fisier temporar per proces,
+// redenumit la final, ca doua lansari simultane sa nu citeasca un binar partial.
+const uint32_t PROGRAM_CACHE_MAGIC = 0x50524742u; // "PRGB"
+int programCacheHits = 0, programCacheMisses = 0;
+
+bool programBinarySupported() {
+    if (!GLEW_ARB_get_program_binary && !GLEW_VERSION_4_1) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::string programCachePath(const std::string& vs, const std::string& fs) {
+    uint64_t h = 14695981039346656037ull;
+    const GLenum ids[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (GLenum id : ids) {
+        const char* str = (const char*)glGetString(id);
+        if (str) h = fnv1a(h, str, strlen(str) + 1);
+    }
+    h = fnv1a(h, vs.data(), vs.size() + 1);
+    h = fnv1a(h, fs.data(), fs.size() + 1);
+    char name[48];
+    snprintf(name, sizeof(name), "shadercache_%016llx.bin", (unsigned long long)h);
+    return name;
+}
+
+// 0 daca nu exista sau driverul nu il accepta.
+GLuint loadProgramBinary(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    uint32_t header[3] = {};   // magic, format, lungime
+    std::vector<char> blob;
+    if (fread(header, sizeof(header), 1, f) == 1 && header[0] == PROGRAM_CACHE_MAGIC && header[2] > 0) {
+        blob.resize(header[2]);
+        if (fread(blob.data(), 1, blob.size(), f) != blob.size()) blob.clear();
+    }
+    fclose(f);
+    if (blob.empty()) return 0;
+    GLuint prog = glCreateProgram();
+    glProgramBinary(prog, (GLenum)header[1], blob.data(), (GLsizei)blob.size());
+    GLint ok = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok) { glDeleteProgram(prog); return 0; }
+    return prog;
+}
+
+void saveProgramBinary(const std::string& path, GLuint prog) {
+    GLint len = 0;
+    glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &len);
+    if (len <= 0) return;
+    std::vector<char> blob(len);
+    GLenum format = 0;
+    glGetProgramBinary(prog, len, &len, &format, blob.data());
+#ifdef _WIN32
+    const std::string tmp = path + "." + std::to_string(GetCurrentProcessId()) + ".tmp";
+#else
+    const std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+#endif
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    uint32_t header[3] = { PROGRAM_CACHE_MAGIC, (uint32_t)format, (uint32_t)len };
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(blob.data(), 1, len, f) == (size_t)len;
+    if (fclose(f) != 0) ok = false;
+#ifdef _WIN32
+    if (ok) ok = MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+    if (!ok) remove(tmp.c_str());
+}
 
+// O linie dupa ce s-au incarcat programele (nimic daca driverul nu are binare).
+void reportProgramCache() {
+    if (programCacheHits + programCacheMisses == 0) return;
+    std::cout << "shader cache: " << programCacheHits << " hits, " << programCacheMisses << " misses\n";
+}
+
+// defines: ex. "#define SPRITE_TEXTURED\n"; 0 la eroare.
+GLuint loadShaderVariant(const char* vertPath, const char* fragPath, const char* defines) {
+    std::string vs = readTextFile(vertPath), fs = readTextFile(fragPath);
+    if (vs.empty() || fs.empty()) { std::cerr << "Cannot read " << vertPath << " / " << fragPath << std::endl; return 0; }
+    vs = withDefines(vs, defines);
+    fs = withDefines(fs, defines);
+
+    const bool cache = programBinarySupported();
+    std::string cachePath;
+    if (cache) {
+        cachePath = programCachePath(vs, fs);
+        if (GLuint prog = loadProgramBinary(cachePath)) { ++programCacheHits; return prog; }
+        ++programCacheMisses;
+    }
+
+    GLuint v = compileShader(GL_VERTEX_SHADER, vs, vertPath);
+    GLuint f = compileShader(GL_FRAGMENT_SHADER, fs, fragPath);
+    GLuint prog = 0;
+    if (v && f) {
+        prog = glCreateProgram();
+        if (cache) glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(prog, v);
+        glAttachShader(prog, f);
+        glLinkProgram(prog);
+        GLint ok = 0;
+        glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[2048];
+            glGetProgramInfoLog(prog, sizeof(log), nullptr, log);
+            std::cerr << "Program " << vertPath << " + " << fragPath << " [" << defines << "] failed:\n" << log << std::endl;
+            glDeleteProgram(prog);
+            prog = 0;
+        }
+    }
+    if (v) glDeleteShader(v);
+    if (f) glDeleteShader(f);
+    if (prog && cache) saveProgramBinary(cachePath, prog);
+    return prog;
+}
+
+// ------------------------- GL OBJECTS & UNIFORMS -------------------------
 GLuint quadVAO = 0;
 GLuint quadVBO = 0;
 GLuint lineVAO = 0;
-GLuint lineVBO = 0;
 
 static const float quadData[] = {
     -0.5f, -0.5f,  0.0f, 0.0f,
@@ -155,17 +420,273 @@ void createQuad() {
     glBindVertexArray(0);
 }
 
+// O instanta per linie de banda: (x fata de camera, faza); varfurile vin din gl_VertexID.
+// Datele sunt in streamBuffer, pointerul atributului se seteaza la fiecare desenare.
 void createLineBuffer() {
     glGenVertexArrays(1, &lineVAO);
-    glGenBuffers(1, &lineVBO);
     glBindVertexArray(lineVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
-    glBufferData(GL_ARRAY_BUFFER, 32768 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glVertexAttribDivisor(0, 1);
     glBindVertexArray(0);
 }
 
+// ------------------------- STREAM BUFFER -------------------------
+// Un singur VBO pentru tot ce se schimba in fiecare cadru (instantele de sprite,
+// inclusiv trail-ul, si liniile de banda). Cu ARB_buffer_storage e mapat persistent
+// si impartit in STREAM_FRAMES regiuni, fiecare pazita de un fence: CPU-ul scrie
+// direct in regiunea cadrului curent cat timp GPU-ul inca citeste din celelalte.
+// Fara extensie e un inel peste tot bufferul, cu orphaning cand se umple.
+// Desenele se trimit abia la submitRenderQueue(), deci bufferul nu are voie sa fie
+// orfanizat sau inlocuit cat timp exista comenzi in coada: reserve() face asta o
+// singura data, la inceputul cadrului, pentru toti octetii cadrului; write() doar
+// consuma din rezervare.
+const int STREAM_FRAMES = 3;
+
+struct StreamBuffer {
+    GLuint vbo = 0;
+    size_t regionSize = 0;           // octeti per cadru
+    bool persistent = false;
+    unsigned char* mapped = nullptr;
+    GLsync fences[STREAM_FRAMES] = {};
+    int frame = 0;
+    size_t head = 0;                 // in regiunea cadrului (persistent) sau in tot bufferul
+    int waits = 0, grows = 0;        // de cate ori s-a asteptat un fence / s-a marit bufferul
+
+    void create(size_t bytesPerFrame) {
+        regionSize = (bytesPerFrame + 255) & ~(size_t)255;
+        const size_t total = regionSize * STREAM_FRAMES;
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        persistent = false;
+        if (GLEW_ARB_buffer_storage) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+            persistent = mapped != nullptr;
+            if (!persistent) {  // storage-ul e imutabil, luam alt buffer
+                glDeleteBuffers(1, &vbo);
+                glGenBuffers(1, &vbo);
+                glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            }
+        }
+        if (!persistent) glBufferData(GL_ARRAY_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        head = 0;
+    }
+
+    void destroy() {
+        for (GLsync& f : fences) if (f) { glDeleteSync(f); f = nullptr; }
+        if (persistent) { glBindBuffer(GL_ARRAY_BUFFER, vbo); glUnmapBuffer(GL_ARRAY_BUFFER); }
+        glDeleteBuffers(1, &vbo);
+        vbo = 0; mapped = nullptr;
+    }
+
+    // Trece la regiunea urmatoare si asteapta doar daca GPU-ul inca o citeste.
+    void beginFrame() {
+        if (!persistent) return;
+        frame = (frame + 1) % STREAM_FRAMES;
+        head = 0;
+        GLsync& f = fences[frame];
+        if (!f) return;
+        if (glClientWaitSync(f, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            ++waits;
+            while (glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+        }
+        glDeleteSync(f);
+        f = nullptr;
+    }
+
+    void endFrame() {
+        if (persistent) fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Octetii pentru `writes` scrieri de `bytes` in total (cu alinierea fiecareia).
+    static size_t frameBytes(size_t bytes, int writes) { return bytes + 15 * (size_t)writes; }
+
+    // Garanteaza ca urmatorii `bytes` octeti incap fara orphaning si fara buffer nou.
+    // Se apeleaza doar cand nu e nicio comanda in coada care sa foloseasca bufferul.
+    void reserve(size_t bytes) {
+        size_t at = (head + 15) & ~(size_t)15;
+        const size_t limit = persistent ? regionSize : regionSize * STREAM_FRAMES;
+        if (at + bytes <= limit) return;
+        if (persistent || bytes > regionSize) {
+            // cadrul nu incape: buffer nou, mai mare (desenele cadrelor trecute
+            // pastreaza bufferul vechi pana termina GPU-ul cu el)
+            size_t want = std::max(regionSize * 2, (bytes + 255) & ~(size_t)255);
+            destroy();
+            create(want);
+            ++grows;
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, regionSize * STREAM_FRAMES, nullptr, GL_STREAM_DRAW);
+        }
+        head = 0;
+    }
+
+    // Copiaza datele si intoarce offsetul lor in vbo (aliniat la 16 octeti), -1 daca
+    // nu a fost rezervat loc. Lasa vbo legat la GL_ARRAY_BUFFER, pentru glVertexAttribPointer.
+    GLintptr write(const void* data, size_t bytes) {
+        size_t at = (head + 15) & ~(size_t)15;
+        const size_t limit = persistent ? regionSize : regionSize * STREAM_FRAMES;
+        if (at + bytes > limit) return -1;
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        GLintptr offset;
+        if (persistent) {
+            offset = (GLintptr)(frame * regionSize + at);
+            memcpy(mapped + offset, data, bytes);
+        } else {
+            offset = (GLintptr)at;
+            void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, bytes,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (dst) { memcpy(dst, data, bytes); glUnmapBuffer(GL_ARRAY_BUFFER); }
+        }
+        head = at + bytes;
+        return offset;
+    }
+};
+
+StreamBuffer streamBuffer;
+
+// ------------------------- RENDER QUEUE -------------------------
+// Desenele din cadru se inregistreaza ca RenderCmd, se sorteaza o data (radix,
+// stabil) dupa cheie si se trimit prin glState, care sare peste legarile si
+// uniform-urile care nu schimba nimic. Cheia: strat | program | textura | VAO | blend.
+// Stratul e primul ca sa pastram ordinea de desenare (benzile sub sprite-uri);
+// in acelasi strat ordinea dintre texturi diferite nu e garantata.
+struct GLStateCache {
+    struct UniformSlot { GLuint program; GLint loc; int count; float v[16]; };
+    GLuint program = ~0u, vao = ~0u, texture = ~0u;
+    int blend = -1;
+    float lineWidth = -1.0f;
+    std::vector<UniformSlot> uniforms;
+    int changes = 0, skipped = 0;             // cadrul curent
+    int lastChanges = 0, lastSkipped = 0;     // cadrul trecut, pentru HUD
+
+    // dupa apeluri GL facute pe langa cache
+    void invalidate() { program = vao = texture = ~0u; blend = -1; lineWidth = -1.0f; uniforms.clear(); }
+    void beginFrame() { lastChanges = changes; lastSkipped = skipped; changes = skipped = 0; }
+
+    bool differs(bool d) { d ? ++changes : ++skipped; return d; }
+    void useProgram(GLuint p) { if (differs(p != program)) { glUseProgram(p); program = p; } }
+    void bindVertexArray(GLuint v) { if (differs(v != vao)) { glBindVertexArray(v); vao = v; } }
+    // unitatea 0 e mereu cea activa
+    void bindTexture(GLuint t) { if (differs(t != texture)) { glBindTexture(GL_TEXTURE_2D, t); texture = t; } }
+    void setBlend(bool b) {
+        if (differs((int)b != blend)) { b ? glEnable(GL_BLEND) : glDisable(GL_BLEND); blend = b; }
+    }
+    void setLineWidth(float w) { if (differs(w != lineWidth)) { glLineWidth(w); lineWidth = w; } }
+
+    // count = 1, 2, 4 sau 16 (mat4); programul trebuie sa fie cel curent
+    void uniform(GLint loc, const float* v, int count) {
+        if (loc < 0) return;
+        UniformSlot* slot = nullptr;
+        for (UniformSlot& u : uniforms) if (u.program == program && u.loc == loc) { slot = &u; break; }
+        if (slot && slot->count == count && memcmp(slot->v, v, count * sizeof(float)) == 0) { ++skipped; return; }
+        if (!slot) { uniforms.push_back(UniformSlot{ program, loc, count, {} }); slot = &uniforms.back(); }
+        slot->count = count;
+        memcpy(slot->v, v, count * sizeof(float));
+        ++changes;
+        switch (count) {
+        case 1: glUniform1fv(loc, 1, v); break;
+        case 2: glUniform2fv(loc, 1, v); break;
+        case 4: glUniform4fv(loc, 1, v); break;
+        default: glUniformMatrix4fv(loc, 1, GL_FALSE, v); break;
+        }
+    }
+};
+
+GLStateCache glState;
+
+enum RenderLayer { LAYER_LANES, LAYER_TRAIL, LAYER_SPRITES };
+enum CmdLayout { LAYOUT_SPRITE, LAYOUT_LINE };  // cum se leaga atributele per instanta
+
+struct CmdUniform { GLint loc; int count; float v[16]; };
+
+struct RenderCmd {
+    uint64_t key;
+    GLuint program, vao, texture;
+    bool blend;
+    uint8_t layout;
+    GLenum mode;
+    GLsizei vertices, instances;
+    GLintptr instanceOffset;     // in streamBuffer
+    float lineWidth;
+    int uniformFirst, uniformCount;
+};
+
+std::vector<RenderCmd> renderCmds, renderCmdsTmp;
+std::vector<CmdUniform> renderUniforms;
+int renderDrawCalls = 0;         // ultimul cadru
+bool showRenderStats = false;    // tasta I
+
+inline uint64_t renderKey(int layer, GLuint program, GLuint texture, GLuint vao, bool blend) {
+    return ((uint64_t)(layer & 0xff) << 56) | ((uint64_t)(program & 0xffff) << 40) |
+           ((uint64_t)(texture & 0xffff) << 24) | ((uint64_t)(vao & 0xffff) << 8) | (blend ? 1u : 0u);
+}
+
+void queueUniform(GLint loc, const float* v, int count) {
+    CmdUniform u = { loc, count, {} };
+    memcpy(u.v, v, count * sizeof(float));
+    renderUniforms.push_back(u);
+}
+
+// Uniform-urile adaugate cu queueUniform() de la ultimul queueDraw() ii apartin.
+void queueDraw(int layer, GLuint program, GLuint texture, GLuint vao, bool blend, CmdLayout layout,
+               GLenum mode, GLsizei vertices, GLsizei instances, GLintptr instanceOffset, float lineWidth = 1.0f) {
+    int first = renderCmds.empty() ? 0 : renderCmds.back().uniformFirst + renderCmds.back().uniformCount;
+    RenderCmd c = { renderKey(layer, program, texture, vao, blend), program, vao, texture, blend, (uint8_t)layout,
+                    mode, vertices, instances, instanceOffset, lineWidth, first, (int)renderUniforms.size() - first };
+    renderCmds.push_back(c);
+}
+
+// LSD radix pe cifre de 16 biti; sare peste cifrele egale la toate comenzile.
+void sortRenderQueue() {
+    const size_t n = renderCmds.size();
+    if (n < 2) return;
+    uint64_t same = ~0ull;
+    for (const RenderCmd& c : renderCmds) same &= ~(c.key ^ renderCmds[0].key);
+    renderCmdsTmp.resize(n);
+    std::vector<uint32_t> count(1 << 16);
+    for (int shift = 0; shift < 64; shift += 16) {
+        if (((same >> shift) & 0xffff) == 0xffff) continue;
+        std::fill(count.begin(), count.end(), 0);
+        for (const RenderCmd& c : renderCmds) ++count[(c.key >> shift) & 0xffff];
+        uint32_t sum = 0;
+        for (uint32_t& k : count) { uint32_t t = k; k = sum; sum += t; }
+        for (const RenderCmd& c : renderCmds) renderCmdsTmp[count[(c.key >> shift) & 0xffff]++] = c;
+        renderCmds.swap(renderCmdsTmp);
+    }
+}
+
+void submitRenderQueue() {
+    sortRenderQueue();
+    renderDrawCalls = 0;
+    for (const RenderCmd& c : renderCmds) {
+        glState.useProgram(c.program);
+        for (int u = c.uniformFirst; u < c.uniformFirst + c.uniformCount; ++u)
+            glState.uniform(renderUniforms[u].loc, renderUniforms[u].v, renderUniforms[u].count);
+        glState.bindVertexArray(c.vao);
+        if (c.texture) glState.bindTexture(c.texture);  // 0 = nu citeste texturi
+        glState.setBlend(c.blend);
+        // GL 3.3 nu are base instance: mutam pointerii la inceputul datelor comenzii
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.vbo);
+        const char* base = (const char*)c.instanceOffset;
+        if (c.layout == LAYOUT_SPRITE) {
+            const GLsizei stride = 13 * sizeof(float);  // SpriteInstance
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, base);
+            glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, base + 4 * sizeof(float));
+            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, base + 5 * sizeof(float));
+            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, base + 9 * sizeof(float));
+        } else {
+            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), base);
+            glState.setLineWidth(c.lineWidth);
+        }
+        glDrawArraysInstanced(c.mode, 0, c.vertices, c.instances);
+        ++renderDrawCalls;
+    }
+    renderCmds.clear();
+    renderUniforms.clear();
+}
+
 // ------------------------- MATH HELPERS -------------------------
 struct Mat4 { float m[16]; };
 Mat4 mat_identity() { Mat4 r{}; r.m[0] = 1; r.m[5] = 1; r.m[10] = 1; r.m[15] = 1; return r; }
@@ -204,136 +725,370 @@ void initLanes(int numLeft = 12, int numRight = 12, float width = 0.6f) {
 
 
 
-void spawnReward() {
-    if (laneCenters.empty()) return;
+void spawnRewardFrom(uint32_t laneBits, uint32_t aheadBits) {
+    if (laneCenters.empty() || rewards.size() >= MAX_REWARDS) return;
     Reward r;
-    r.x = laneCenters[randomInt(0, (int)laneCenters.size() - 1)];
-    r.y = playerY + randomFloat(2.0f, 5.0f);
+    r.x = laneCenters[rngInt(laneBits, 0, (int)laneCenters.size() - 1)];
+    r.y = playerY + rngRange(aheadBits, 2.0f, 5.0f);
     r.collected = false;
     rewards.push_back(r);
 }
 
+void spawnReward() {
+    uint32_t laneBits = gen.nextU32();
+    spawnRewardFrom(laneBits, gen.nextU32());
+}
+
+// In update(): al n-lea spawn din tick-ul curent
+void spawnRewardTick(uint32_t n) {
+    Philox4 r = tickRandom(n, RNG_REWARD_SPAWN);
+    spawnRewardFrom(r.v[0], r.v[1]);
+}
+
 void resetGame() {
     playerX = 0.0f; playerY = 0.0f; playerSpeed = 0.0f; drift = 0.0f; rotSmooth = 0.0f;
-    gameOver = false; trail.clear(); aiCars.clear(); rewards.clear(); score = 0;
+    gameOver = false; trail.clear(); rewards.clear(); score = 0;
+    emitEvent(EV_RESET, playerX, playerY, 0);
     if (laneCenters.empty()) initLanes(laneNumLeft, laneNumRight, laneWidth);
-    for (int i = 0; i < NUM_AI_CARS; ++i) {
-        Car c;
+    // masinile se suprascriu pe loc; resize() aloca doar cand creste numAiCars
+    aiCars.resize(numAiCars);
+    for (Car& c : aiCars) {
         c.x = laneCenters[randomInt(0, (int)laneCenters.size() - 1)];
         const float safeAhead = 1.0f;
         c.y = playerY + safeAhead + randomFloat(AI_MIN_Y, AI_MAX_Y);
         c.speed = AI_SPEED * randomFloat(0.9f, 1.4f);
-        aiCars.push_back(c);
     }
     for (int i = 0; i < 8; ++i) spawnReward();
 }
 
+// ------------------------- SNAPSHOT -------------------------
+// Toata starea jocului intr-un bloc fara pointeri: clonarea e o atribuire (un memcpy)
+// (planificatoare, rollout-uri ramificate).
+static_assert(NUM_AI_CARS <= MAX_AI_CARS, "NUM_AI_CARS > MAX_AI_CARS");
+
+struct GameSnapshot {
+    float playerX, playerY, playerSpeed, rotSmooth, drift;
+    int score;
+    bool gameOver;
+    uint64_t simTick;
+    float trailLastX, trailLastY;
+    float lineDashOffset;
+    float camX, camY;
+    float laneWidth;
+    int laneNumLeft, laneNumRight;
+    int numCars, numRewards, numTrail, numLanes;
+    Car cars[MAX_AI_CARS];
+    Reward rewards[MAX_REWARDS];
+    float trail[TRAIL_MAX + 1][2];
+    float laneCenters[MAX_LANES];
+    float lineOffsets[MAX_LANES];
+    BlockRng rng;
+    uint64_t rngSeed;
+};
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot must be memcpy-able");
+
+// false daca lumea nu incape in capacitatile fixe (ex. lumi mari de benchmark)
+bool snapshot(GameSnapshot& s) {
+    if (aiCars.size() > MAX_AI_CARS || rewards.size() > MAX_REWARDS ||
+        trail.size() > (size_t)TRAIL_MAX + 1 || laneCenters.size() > MAX_LANES || lineOffsets.size() != laneCenters.size())
+        return false;
+    s.playerX = playerX; s.playerY = playerY; s.playerSpeed = playerSpeed; s.rotSmooth = rotSmooth; s.drift = drift;
+    s.score = score; s.gameOver = gameOver; s.simTick = simTick;
+    s.trailLastX = trail_last_x; s.trailLastY = trail_last_y;
+    s.lineDashOffset = lineDashOffset;
+    s.camX = camX; s.camY = camY;
+    s.laneWidth = laneWidth; s.laneNumLeft = laneNumLeft; s.laneNumRight = laneNumRight;
+    s.numCars = (int)aiCars.size();
+    s.numRewards = (int)rewards.size();
+    s.numTrail = (int)trail.size();
+    s.numLanes = (int)laneCenters.size();
+    if (s.numCars) memcpy(s.cars, aiCars.data(), s.numCars * sizeof(Car));
+    if (s.numRewards) memcpy(s.rewards, rewards.data(), s.numRewards * sizeof(Reward));
+    int i = 0;
+    for (auto& p : trail) { s.trail[i][0] = p.first; s.trail[i][1] = p.second; ++i; }
+    if (s.numLanes) {
+        memcpy(s.laneCenters, laneCenters.data(), s.numLanes * sizeof(float));
+        memcpy(s.lineOffsets, lineOffsets.data(), s.numLanes * sizeof(float));
+    }
+    s.rng = gen;
+    s.rngSeed = rngSeed;
+    return true;
+}
+
+void restore(const GameSnapshot& s) {
+    playerX = s.playerX; playerY = s.playerY; playerSpeed = s.playerSpeed; rotSmooth = s.rotSmooth; drift = s.drift;
+    score = s.score; gameOver = s.gameOver; simTick = s.simTick;
+    trail_last_x = s.trailLastX; trail_last_y = s.trailLastY;
+    lineDashOffset = s.lineDashOffset;
+    camX = s.camX; camY = s.camY;
+    laneWidth = s.laneWidth; laneNumLeft = s.laneNumLeft; laneNumRight = s.laneNumRight;
+    // assign() refoloseste capacitatea existenta, fara alocari dupa primul restore
+    aiCars.assign(s.cars, s.cars + s.numCars);
+    rewards.assign(s.rewards, s.rewards + s.numRewards);
+    trail.clear();
+    for (int i = 0; i < s.numTrail; ++i) trail.emplace_back(s.trail[i][0], s.trail[i][1]);
+    laneCenters.assign(s.laneCenters, s.laneCenters + s.numLanes);
+    lineOffsets.assign(s.lineOffsets, s.lineOffsets + s.numLanes);
+    gen = s.rng;
+    rngSeed = s.rngSeed;
+}
+
+// ------------------------- CHECKPOINT -------------------------
+// Lumea curenta pe disc in formatul din checkpoint.h (coloane aliniate).
+bool saveCheckpoint(const char* path) {
+    CheckpointHeader h = {};
+    h.playerX = playerX; h.playerY = playerY; h.playerSpeed = playerSpeed; h.rotSmooth = rotSmooth; h.drift = drift;
+    h.score = score; h.gameOver = gameOver ? 1u : 0u; h.simTick = simTick; h.rngSeed = rngSeed;
+    h.trailLastX = trail_last_x; h.trailLastY = trail_last_y;
+    h.lineDashOffset = lineDashOffset;
+    h.camX = camX; h.camY = camY;
+    h.laneWidth = laneWidth; h.laneNumLeft = laneNumLeft; h.laneNumRight = laneNumRight;
+    h.numCars = aiCars.size(); h.numRewards = rewards.size(); h.numTrail = trail.size();
+    h.numLanes = laneCenters.size(); h.rngBytes = sizeof(gen);
+
+    std::vector<float> carX(h.numCars), carY(h.numCars), carSpeed(h.numCars);
+    for (size_t i = 0; i < aiCars.size(); ++i) { carX[i] = aiCars[i].x; carY[i] = aiCars[i].y; carSpeed[i] = aiCars[i].speed; }
+    std::vector<float> rewardX(h.numRewards), rewardY(h.numRewards);
+    std::vector<uint8_t> rewardCollected(h.numRewards);
+    for (size_t i = 0; i < rewards.size(); ++i) { rewardX[i] = rewards[i].x; rewardY[i] = rewards[i].y; rewardCollected[i] = rewards[i].collected; }
+    std::vector<float> trailX, trailY;
+    for (auto& p : trail) { trailX.push_back(p.first); trailY.push_back(p.second); }
+
+    CheckpointView v = {};
+    v.carX = carX.data(); v.carY = carY.data(); v.carSpeed = carSpeed.data();
+    v.rewardX = rewardX.data(); v.rewardY = rewardY.data(); v.rewardCollected = rewardCollected.data();
+    v.trailX = trailX.data(); v.trailY = trailY.data();
+    v.laneCenters = laneCenters.data(); v.lineOffsets = lineOffsets.data();
+    v.rng = &gen;
+    return writeCheckpoint(path, h, v);
+}
+
+// Header-ul si coloanele se citesc direct din mmap (fara parsare), dar simularea
+// lucreaza pe aiCars/rewards (struct-uri), deci coloanele se copiaza o data in ele:
+// O(masini + monede), ~12 B/masina (200000 de masini = 2.4 MB).
+bool loadCheckpoint(const char* path) {
+    MappedCheckpoint m;
+    if (!mapCheckpoint(path, m)) return false;
+    const CheckpointHeader& h = *m.view.header;
+    if (h.rngBytes != sizeof(gen) || h.numLanes == 0) {
+        std::cerr << "checkpoint: " << path << " was written by an incompatible build\n";
+        unmapCheckpoint(m);
+        return false;
+    }
+    const CheckpointView& v = m.view;
+    playerX = h.playerX; playerY = h.playerY; playerSpeed = h.playerSpeed; rotSmooth = h.rotSmooth; drift = h.drift;
+    score = h.score; gameOver = h.gameOver != 0; simTick = h.simTick; rngSeed = h.rngSeed;
+    trail_last_x = h.trailLastX; trail_last_y = h.trailLastY;
+    lineDashOffset = h.lineDashOffset;
+    camX = h.camX; camY = h.camY;
+    laneWidth = h.laneWidth; laneNumLeft = h.laneNumLeft; laneNumRight = h.laneNumRight;
+
+    numAiCars = (int)h.numCars;
+    aiCars.resize(h.numCars);
+    for (size_t i = 0; i < aiCars.size(); ++i) { aiCars[i].x = v.carX[i]; aiCars[i].y = v.carY[i]; aiCars[i].speed = v.carSpeed[i]; }
+    rewards.resize(h.numRewards);
+    for (size_t i = 0; i < rewards.size(); ++i) { rewards[i].x = v.rewardX[i]; rewards[i].y = v.rewardY[i]; rewards[i].collected = v.rewardCollected[i] != 0; }
+    trail.clear();
+    for (uint64_t i = 0; i < h.numTrail; ++i) trail.emplace_back(v.trailX[i], v.trailY[i]);
+    laneCenters.assign(v.laneCenters, v.laneCenters + h.numLanes);
+    lineOffsets.assign(v.lineOffsets, v.lineOffsets + h.numLanes);
+    memcpy(&gen, v.rng, sizeof(gen));
+    unmapCheckpoint(m);
+    return true;
+}
+
 // ------------------------- DRAW HELPERS -------------------------
-void drawTexturedQuad(float x, float y, float sx, float sy, float angleDeg, GLuint texture) {
-    Mat4 T = mat_translate(x, y);
-    Mat4 R = mat_rotateZ(angleDeg);
-    Mat4 S = mat_scale(sx, sy);
-    Mat4 M = mat_mul(T, mat_mul(R, S));
-    if (codColVertLoc >= 0) glUniformMatrix4fv(codColVertLoc, 1, GL_FALSE, M.m);
-    if (codColLocation >= 0) glUniform1i(codColLocation, 0); // textured mode
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    if (uTexLoc >= 0) glUniform1i(uTexLoc, 0);
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+// Sprite-urile unui cadru se aduna intr-un singur buffer de instante (pushSprite)
+// si se deseneaza din queueSprites() cu cate un glDrawArraysInstanced per secventa
+// consecutiva cu aceeasi textura, deci numarul de draw call-uri nu depinde de
+// cate masini/monede/puncte de trail sunt. Sprite-urile texturate (atlasul) si
+// cele de o singura culoare (trail-ul) au programe separate, deci secvente separate.
+struct SpriteInstance {
+    float x, y, w, h;
+    float rot;              // grade
+    float u0, v0, u1, v1;
+    float r, g, b, a;
+};
+struct SpriteRun { GLuint program; GLint projLoc; GLuint texture; int layer, first, count; };
+
+GLuint spriteProgram = 0, solidProgram = 0;   // SPRITE_TEXTURED, SPRITE_SOLID
+GLuint spriteVAO = 0;
+GLint spriteProjLoc = -1, solidProjLoc = -1;
+std::vector<SpriteInstance> spriteInstances;
+std::vector<SpriteRun> spriteRuns;
+
+static const float whiteColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+void createSpriteBuffers() {
+    glGenVertexArrays(1, &spriteVAO);
+    glBindVertexArray(spriteVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    for (int loc = 2; loc <= 5; ++loc) { glEnableVertexAttribArray(loc); glVertexAttribDivisor(loc, 1); }
+    glBindVertexArray(0);
 }
 
-void drawColoredQuad(float x, float y, float sx, float sy, float angleDeg, const float color[4]) {
-    Mat4 T = mat_translate(x, y);
-    Mat4 R = mat_rotateZ(angleDeg);
-    Mat4 S = mat_scale(sx, sy);
-    Mat4 M = mat_mul(T, mat_mul(R, S));
-    if (codColVertLoc >= 0) glUniformMatrix4fv(codColVertLoc, 1, GL_FALSE, M.m);
-    if (codColLocation >= 0) glUniform1i(codColLocation, 1); // color mode
-    if (uColorLoc >= 0) glUniform4fv(uColorLoc, 1, color);
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void pushSpriteInstance(GLuint program, GLint projLoc, GLuint texture, int layer, const SpriteInstance& s) {
+    if (spriteRuns.empty() || spriteRuns.back().program != program || spriteRuns.back().texture != texture ||
+        spriteRuns.back().layer != layer)
+        spriteRuns.push_back({ program, projLoc, texture, layer, (int)spriteInstances.size(), 0 });
+    spriteRuns.back().count++;
+    spriteInstances.push_back(s);
+}
+
+void pushSprite(GLuint texture, float x, float y, float sx, float sy, float angleDeg,
+                const float uv[4], const float color[4] = whiteColor) {
+    SpriteInstance s = { x, y, sx, sy, angleDeg, uv[0], uv[1], uv[2], uv[3], color[0], color[1], color[2], color[3] };
+    pushSpriteInstance(spriteProgram, spriteProjLoc, texture, LAYER_SPRITES, s);
+}
+
+void pushColoredSprite(float x, float y, float sx, float sy, float angleDeg, const float color[4], int layer = LAYER_SPRITES) {
+    SpriteInstance s = { x, y, sx, sy, angleDeg, 0.0f, 0.0f, 0.0f, 0.0f, color[0], color[1], color[2], color[3] };
+    pushSpriteInstance(solidProgram, solidProjLoc, 0, layer, s);
+}
+
+// Un upload pentru tot cadrul, apoi cate o comanda instantiata per secventa.
+void queueSprites(const Mat4& proj) {
+    if (spriteInstances.empty()) { spriteRuns.clear(); return; }
+    GLintptr offset = streamBuffer.write(spriteInstances.data(), spriteInstances.size() * sizeof(SpriteInstance));
+    if (offset < 0) { spriteInstances.clear(); spriteRuns.clear(); return; }
+    for (const SpriteRun& run : spriteRuns) {
+        queueUniform(run.projLoc, proj.m, 16);
+        queueDraw(run.layer, run.program, run.texture, spriteVAO, true, LAYOUT_SPRITE, GL_TRIANGLES, 6, run.count,
+                  offset + run.first * sizeof(SpriteInstance));
+    }
+    spriteInstances.clear();
+    spriteRuns.clear();
 }
 
-void drawLines(const std::vector<float>& verts, const std::vector<float>& offsets, const float color[4], float lineWidth = 3.0f) {
-    if (verts.empty() || offsets.empty()) return;
+// Liniile de banda: modelul liniuta/pauza e evaluat in scene.frag (LANE_LINE) din distanta de-a
+// lungul liniei si faza benzii, deci pe CPU urca doar 2 float-uri per banda.
+GLuint lineProgram = 0;
+GLint lineProjLoc = -1, lineSpanLoc = -1, lineColorLoc = -1, lineDashLoc = -1;
+std::vector<float> lineInstances;
+
+// Doar liniile cu x in [minX, maxX] (coordonate de lume).
+void pushLaneLines(float minX, float maxX) {
+    lineInstances.clear();
+    if (laneCenters.empty() || lineOffsets.empty()) return;
+    const int first = std::max(-laneNumLeft, (int)ceilf(minX / laneWidth));
+    const int last = std::min(laneNumRight, (int)floorf(maxX / laneWidth));
+    for (int i = first; i <= last; ++i) {
+        lineInstances.push_back(i * laneWidth - camX);
+        lineInstances.push_back(lineOffsets[(i + laneNumLeft) % lineOffsets.size()]);
+    }
+}
 
+void queueLaneLines(const Mat4& proj, float startY, float endY, const float color[4], float lineWidth = 3.0f) {
+    if (lineInstances.empty()) return;
     const float dashLen = 1.50f;
     const float gapLen = 0.5f;
-    float patternLen = dashLen + gapLen;
+    GLintptr offset = streamBuffer.write(lineInstances.data(), lineInstances.size() * sizeof(float));
+    if (offset < 0) return;
+    const float span[2] = { startY, endY }, dash[2] = { dashLen, dashLen + gapLen };
+    queueUniform(lineProjLoc, proj.m, 16);
+    queueUniform(lineSpanLoc, span, 2);
+    queueUniform(lineColorLoc, color, 4);
+    queueUniform(lineDashLoc, dash, 2);
+    queueDraw(LAYER_LANES, lineProgram, 0, lineVAO, true, LAYOUT_LINE, GL_LINES, 2,
+              (GLsizei)(lineInstances.size() / 2), offset, lineWidth);
+}
 
-    std::vector<float> dashed;
-    dashed.reserve(verts.size() * 2);
-
-    for (size_t i = 0, lineIdx = 0; i + 3 < verts.size(); i += 4, ++lineIdx) {
-        float x1 = verts[i + 0], y1 = verts[i + 1];
-        float x2 = verts[i + 2], y2 = verts[i + 3];
-
-        float dx = x2 - x1, dy = y2 - y1;
-        float len = sqrtf(dx * dx + dy * dy);
-        if (len <= 0.0001f) continue;
-        float ux = dx / len, uy = dy / len;
-
-        float localOffset = offsets[lineIdx % offsets.size()];
-        float pos = -localOffset;
-
-        while (pos < len) {
-            float segStart = std::max(0.0f, pos);
-            float segEnd = std::min(len, pos + dashLen);
-            if (segEnd > segStart + 1e-6f) {
-                float sx = x1 + ux * segStart;
-                float sy = y1 + uy * segStart;
-                float ex = x1 + ux * segEnd;
-                float ey = y1 + uy * segEnd;
-                dashed.push_back(sx); dashed.push_back(sy);
-                dashed.push_back(ex); dashed.push_back(ey);
-            }
-            pos += patternLen;
-        }
-    }
+// ------------------------- STATE HASH -------------------------
+// Hash per camp, recalculat la fiecare tick. Variantele optimizate ale lui
+// stepGame() trebuie sa dea exact aceleasi valori ca referinta scalara.
+enum HashField { HF_PLAYER, HF_CARS, HF_COINS, HF_SCORE, HF_TRAIL, HF_LANES, HF_RNG, HF_COUNT };
+static const char* hashFieldNames[HF_COUNT] = { "player", "aiCars", "rewards", "score", "trail", "lanes", "rng" };
 
-    if (dashed.empty()) return;
+struct StateHash {
+    uint64_t field[HF_COUNT];
+    uint64_t combined;
+};
 
-    Mat4 I = mat_identity();
-    if (codColVertLoc >= 0) glUniformMatrix4fv(codColVertLoc, 1, GL_FALSE, I.m);
-    if (codColLocation >= 0) glUniform1i(codColLocation, 1); // color mode
-    if (uColorLoc >= 0) glUniform4fv(uColorLoc, 1, color);
+StateHash stateHash = {};
+// Hash-ul costa cat un pas (trece prin toate masinile, monedele si trail-ul), deci
+// stepGame() il tine la zi doar cand il cere harness-ul (checkDivergence()),
+// care citeste stateHash dupa fiecare pas in loc sa-l recalculeze.
+bool stateHashEnabled = false;
 
-    glBindVertexArray(lineVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, lineVBO);
-    size_t maxFloats = 32768;
-    size_t uploadCount = std::min(dashed.size(), maxFloats);
-    if (uploadCount > 0) {
-        glBufferSubData(GL_ARRAY_BUFFER, 0, uploadCount * sizeof(float), dashed.data());
-        glLineWidth(lineWidth);
-        int cnt = (int)(uploadCount / 2);
-        if (cnt > 0) glDrawArrays(GL_LINES, 0, cnt);
-    }
-    glBindVertexArray(0);
-}
+inline uint64_t hashFloat(uint64_t h, float v) { uint32_t b; memcpy(&b, &v, 4); return fnv1a(h, &b, 4); }
+
+StateHash computeStateHash() {
+    const uint64_t seed = 14695981039346656037ull;
+    StateHash s;
+    uint64_t h = seed;
+    h = hashFloat(h, playerX); h = hashFloat(h, playerY); h = hashFloat(h, playerSpeed);
+    h = hashFloat(h, drift); h = hashFloat(h, rotSmooth); h = fnv1a(h, &gameOver, 1);
+    s.field[HF_PLAYER] = h;
+
+    h = seed;
+    for (auto& c : aiCars) { h = hashFloat(h, c.x); h = hashFloat(h, c.y); h = hashFloat(h, c.speed); }
+    s.field[HF_CARS] = h;
+
+    h = seed;
+    for (auto& r : rewards) { h = hashFloat(h, r.x); h = hashFloat(h, r.y); h = fnv1a(h, &r.collected, 1); }
+    s.field[HF_COINS] = h;
 
+    s.field[HF_SCORE] = fnv1a(seed, &score, sizeof(score));
 
+    h = seed;
+    for (auto& p : trail) { h = hashFloat(h, p.first); h = hashFloat(h, p.second); }
+    s.field[HF_TRAIL] = h;
+
+    h = seed;
+    for (float c : laneCenters) h = hashFloat(h, c);
+    for (float o : lineOffsets) h = hashFloat(h, o);
+    s.field[HF_LANES] = h;
+
+    h = fnv1a(seed, &rngSeed, sizeof(rngSeed));
+    h = fnv1a(h, gen.s, sizeof(gen.s));
+    h = fnv1a(h, &gen.cursor, sizeof(gen.cursor));
+    s.field[HF_RNG] = fnv1a(h, &gen.draws, sizeof(gen.draws));
+
+    s.combined = fnv1a(seed, s.field, sizeof(s.field));
+    return s;
+}
+
+void refreshStateHash() { if (stateHashEnabled) stateHash = computeStateHash(); }
 
 // ------------------------- UPDATE -------------------------
-void update() {
-    if (gameOver) { glutPostRedisplay(); return; }
+// Actiunile jucatorului (ACT_*, din batchEnv.h) pentru un tick, separate de
+// tastatura ca simularea sa poata rula si fara fereastra.
+unsigned readInputActions() {
+    unsigned a = 0;
+    if (specialKeyStates[GLUT_KEY_UP] || keyStates['w'] || keyStates['W']) a |= ACT_UP;
+    if (specialKeyStates[GLUT_KEY_DOWN] || keyStates['s'] || keyStates['S']) a |= ACT_DOWN;
+    if (specialKeyStates[GLUT_KEY_LEFT] || keyStates['a'] || keyStates['A']) a |= ACT_LEFT;
+    if (specialKeyStates[GLUT_KEY_RIGHT] || keyStates['d'] || keyStates['D']) a |= ACT_RIGHT;
+    return a;
+}
+
+void stepCosmetics();
+
+// Referinta scalara: un tick de simulare, fara GL.
+void stepGame(unsigned actions) {
+    if (gameOver) return;
+    ++simTick;
 
     const float maxSpeed = 0.02f;
     const float minSpeed = -0.02f;
-    if (specialKeyStates[GLUT_KEY_UP] || keyStates['w'] || keyStates['W']) {
+    if (actions & ACT_UP) {
         playerSpeed += playerAcc; if (playerSpeed > maxSpeed) playerSpeed = maxSpeed;
     }
-    else if (specialKeyStates[GLUT_KEY_DOWN] || keyStates['s'] || keyStates['S']) {
+    else if (actions & ACT_DOWN) {
         playerSpeed -= playerAcc; if (playerSpeed < minSpeed) playerSpeed = minSpeed;
     }
     else {
         playerSpeed = 0.0f;
     }
 
-    if (specialKeyStates[GLUT_KEY_LEFT] || keyStates['a'] || keyStates['A']) {
+    if (actions & ACT_LEFT) {
         playerX -= 0.009f; drift += 0.05f; if (drift > 10.0f) drift = 10.0f;
     }
-    else if (specialKeyStates[GLUT_KEY_RIGHT] || keyStates['d'] || keyStates['D']) {
+    else if (actions & ACT_RIGHT) {
         playerX += 0.009f; drift -= 0.05f; if (drift < -10.0f) drift = -10.0f;
     }
     else drift *= 0.9f;
@@ -347,33 +1102,28 @@ void update() {
 
     playerY += playerSpeed;
 
-    float minScroll = 0.008f;
-    float lineSpeed = minScroll + playerSpeed * 0.3f;
-    lineDashOffset += lineSpeed * dashSpeedFactor;
-    for (size_t i = 0; i < lineOffsets.size(); ++i) {
-        lineOffsets[i] += lineSpeed * dashSpeedFactor;
-    }
-
-
     // --- AI Cars ---
     for (auto& c : aiCars) {
         c.y -= c.speed;
         if (c.y < playerY - 2.0f) {
             bool overlap = false; int attempts = 0, MAX_ATT = 12;
+            uint32_t carId = (uint32_t)(&c - aiCars.data());
             do {
                 overlap = false;
-                if (!laneCenters.empty()) c.x = laneCenters[randomInt(0, (int)laneCenters.size() - 1)];
-                c.y = playerY + randomFloat(AI_SPAWN_AHEAD_MIN, AI_SPAWN_AHEAD_MAX);
+                Philox4 r = tickRandom(carId, RNG_CAR_RESPAWN, attempts);
+                if (!laneCenters.empty()) c.x = laneCenters[rngInt(r.v[0], 0, (int)laneCenters.size() - 1)];
+                c.y = playerY + rngRange(r.v[1], AI_SPAWN_AHEAD_MIN, AI_SPAWN_AHEAD_MAX);
                 for (auto& o : aiCars) {
                     if (&o == &c) continue;
                     if (fabsf(o.x - c.x) < carWidth * 1.05f && fabsf(o.y - c.y) < carHeight * 1.2f) { overlap = true; break; }
                 }
                 ++attempts;
             } while (overlap && attempts < MAX_ATT);
+            emitEvent(EV_RESPAWN, c.x, c.y, (int32_t)(&c - aiCars.data()));
         }
         if (!gameOver && fabsf(playerX - c.x) < carWidth && fabsf(playerY - c.y) < carHeight) {
             gameOver = true;
-            std::cout << "GAME OVER!" << std::endl;
+            emitEvent(EV_COLLISION, c.x, c.y, (int32_t)(&c - aiCars.data()));
         }
     }
 
@@ -384,21 +1134,35 @@ void update() {
         if (!r.collected && fabsf(playerX - r.x) < carWidth / 2.0f && fabsf(playerY - r.y) < carHeight / 2.0f) {
             r.collected = true;
             score += 1;
-            std::cout << "+1 Score! Total: " << score << std::endl;
+            emitEvent(EV_COIN_COLLECTED, r.x, r.y, score);
         }
     }
 
     rewards.erase(std::remove_if(rewards.begin(), rewards.end(), [](Reward& r) { return r.collected || r.y < playerY - 5.0f; }), rewards.end());
 
     const int TARGET_REWARDS = 12;
-    while (rewards.size() < (size_t)TARGET_REWARDS) spawnReward();
+    uint32_t spawnSeq = 0;
+    while (rewards.size() < (size_t)TARGET_REWARDS) spawnRewardTick(spawnSeq++);
 
     float spawnProbBase = 0.002f;
     float spawnProbSpeedScale = playerSpeed * 6.0f;
     float spawnProb = spawnProbBase + spawnProbSpeedScale;
     if (spawnProb > 0.15f) spawnProb = 0.15f;
-    if (randomFloat(0.0f, 1.0f) < spawnProb) {
-        spawnReward();
+    if (rngFloat01(tickRandom(0, RNG_REWARD_ROLL).v[0]) < spawnProb) {
+        spawnRewardTick(spawnSeq++);
+    }
+
+    stepCosmetics();
+    refreshStateHash();
+}
+
+// Liniile intrerupte si trail-ul: depind doar de jucator, nu influenteaza simularea.
+void stepCosmetics() {
+    float minScroll = 0.008f;
+    float lineSpeed = minScroll + playerSpeed * 0.3f;
+    lineDashOffset += lineSpeed * dashSpeedFactor;
+    for (size_t i = 0; i < lineOffsets.size(); ++i) {
+        lineOffsets[i] += lineSpeed * dashSpeedFactor;
     }
 
     // --- TRAIL ---
@@ -410,23 +1174,453 @@ void update() {
         trail_last_x = tx; trail_last_y = ty;
         if ((int)trail.size() > TRAIL_MAX) trail.pop_front();
     }
+}
+
+// ------------------------- TRAJECTORY LOG -------------------------
+// --log-trajectory <fisier>: fiecare tick jucat ajunge ca rand in jurnalul coloanar.
+TrajectoryWriter trajLog;
+bool trajLogging = false;
+
+void logTrajectoryTick(unsigned action, int reward) {
+    static std::vector<float> xs, ys;
+    xs.resize(aiCars.size()); ys.resize(aiCars.size());
+    for (size_t k = 0; k < aiCars.size(); ++k) { xs[k] = aiCars[k].x; ys[k] = aiCars[k].y; }
+    TrajectoryRow r;
+    r.tick = simTick; r.instance = 0;
+    r.playerX = playerX; r.playerY = playerY; r.rot = rotSmooth; r.speed = playerSpeed; r.drift = drift;
+    r.score = score; r.reward = (float)reward;
+    r.action = (uint8_t)action; r.done = gameOver;
+    trajNearestCars(playerX, playerY, laneWidth * 0.5f, xs.data(), ys.data(), (int)xs.size(), AI_SPAWN_AHEAD_MAX, r.nearCars);
+    trajLog.append(r);
+}
 
+bool autopilot = false; // tasta P
+unsigned autopilotAction();
+
+void update() {
+    unsigned actions = autopilot && !gameOver ? autopilotAction() : readInputActions();
+    int scoreBefore = score;
+    bool wasOver = gameOver;
+    stepGame(actions);
+    if (trajLogging && !wasOver) logTrajectoryTick(actions, score - scoreBefore);
+    drainEvents();
     glutPostRedisplay();
 }
 
+// ------------------------- BATCH ENV -------------------------
+BatchConfig configFromGlobals() {
+    BatchConfig c;
+    c.numAiCars = (int)aiCars.size();
+    c.laneNumLeft = laneNumLeft; c.laneNumRight = laneNumRight; c.laneWidth = laneWidth;
+    c.carWidth = carWidth; c.carHeight = carHeight; c.playerAcc = playerAcc;
+    c.aiSpeed = AI_SPEED; c.aiMinY = AI_MIN_Y; c.aiMaxY = AI_MAX_Y;
+    c.aiSpawnAheadMin = AI_SPAWN_AHEAD_MIN; c.aiSpawnAheadMax = AI_SPAWN_AHEAD_MAX;
+    c.maxRewards = MAX_REWARDS;
+    return c;
+}
+
+// Varianta pentru --check-divergence: acelasi tick, calculat de BatchEnv cu o
+// singura instanta incarcata din starea globala.
+BatchEnv checkEnv;
+
+// Starea globala in instanta i (e initializat cu configFromGlobals()).
+void loadInstanceFromGlobals(BatchEnv& e, int i) {
+    e.laneCenters = laneCenters;
+    e.playerX[i] = playerX; e.playerY[i] = playerY; e.playerSpeed[i] = playerSpeed;
+    e.drift[i] = drift; e.rotSmooth[i] = rotSmooth;
+    e.score[i] = score; e.gameOver[i] = gameOver;
+    e.tick[i] = simTick; e.seed[i] = rngSeed;
+    const size_t c0 = (size_t)i * e.carsPerInstance, r0 = (size_t)i * e.rewardCapacity;
+    for (size_t k = 0; k < aiCars.size(); ++k) { e.carX[c0 + k] = aiCars[k].x; e.carY[c0 + k] = aiCars[k].y; e.carSpeed[c0 + k] = aiCars[k].speed; }
+    e.rewardCount[i] = (int32_t)std::min(rewards.size(), (size_t)e.rewardCapacity);
+    for (int k = 0; k < e.rewardCount[i]; ++k) { e.rewardX[r0 + k] = rewards[k].x; e.rewardY[r0 + k] = rewards[k].y; }
+}
+
+void stepGameBatched(unsigned actions) {
+    if (gameOver) return;
+    if (checkEnv.numInstances != 1 || checkEnv.carsPerInstance != (int)aiCars.size()) checkEnv.init(configFromGlobals(), 1, 0);
+    BatchEnv& e = checkEnv;
+    loadInstanceFromGlobals(e, 0);
+
+    uint8_t a = (uint8_t)actions;
+    e.step(&a, nullptr, nullptr, nullptr);
+
+    playerX = e.playerX[0]; playerY = e.playerY[0]; playerSpeed = e.playerSpeed[0];
+    drift = e.drift[0]; rotSmooth = e.rotSmooth[0];
+    score = e.score[0]; gameOver = e.gameOver[0] != 0; simTick = e.tick[0];
+    for (size_t k = 0; k < aiCars.size(); ++k) { aiCars[k].x = e.carX[k]; aiCars[k].y = e.carY[k]; }
+    rewards.resize(e.rewardCount[0]);
+    for (size_t k = 0; k < rewards.size(); ++k) { rewards[k].x = e.rewardX[k]; rewards[k].y = e.rewardY[k]; rewards[k].collected = false; }
+    stepCosmetics();
+    refreshStateHash();
+}
+
+// --bench-batch: game-steps/s pentru N instante cu actiuni aleatoare
+void benchBatch(int instances, int ticks) {
+    BatchConfig cfg;
+    BatchEnv env;
+    std::vector<uint8_t> actions(instances), done(instances);
+    std::vector<float> reward(instances);
+    std::vector<int32_t> scores(instances);
+    // a doua trecere: reset din 1024 de stari precalculate in loc de generare
+    BatchEnv starts;
+    buildStartStates(starts, cfg, 1024, 99, 120);
+    for (int pass = 0; pass < 2; ++pass) {
+        env.init(cfg, instances, 42);
+        env.setStartStates(pass ? &starts : nullptr);
+        BlockRng r = makeBlockRng(7);
+        uint64_t episodes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            for (int i = 0; i < instances; ++i) actions[i] = (uint8_t)(ACT_UP | (r.nextU32() & (ACT_LEFT | ACT_RIGHT)));
+            env.step(actions.data(), reward.data(), done.data(), scores.data(), true);
+            for (int i = 0; i < instances; ++i) episodes += done[i];
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << instances << " instances x " << ticks << " ticks (" << (pass ? "start-state pool" : "generated resets") << ", "
+                  << episodes << " episodes): " << (double)instances * ticks / sec / 1e6 << " M steps/s\n";
+    }
+}
+
+// --bench-trajectory: rollout cu politica aleatoare pe RolloutPool, toate instantele
+// logate in path, apoi fisierul e mapat si verificat (randuri, suma recompenselor).
+// Instantele terminate se reseteaza abia dupa appendBatch, ca randul cu done sa aiba
+// starea in care s-a terminat episodul.
+int benchTrajectory(const char* path, int instances, int ticks) {
+    BatchEnv env;
+    env.init(BatchConfig(), instances, 42);
+    RolloutPool pool;
+    pool.start(env, (int)std::max(1u, std::thread::hardware_concurrency()), 7);
+    std::vector<uint8_t> actions(instances), done(instances);
+    std::vector<float> reward(instances);
+    std::vector<int32_t> scores(instances);
+    TrajectoryWriter w;
+    if (!w.open(path)) return 1;
+    BlockRng r = makeBlockRng(3);
+    double rewardSum = 0.0, logSec = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        for (int i = 0; i < instances; ++i) actions[i] = (uint8_t)(ACT_UP | (r.nextU32() & (ACT_LEFT | ACT_RIGHT)));
+        pool.stepAll(actions.data(), reward.data(), done.data(), scores.data(), false);
+        auto l0 = std::chrono::steady_clock::now();
+        w.appendBatch(env, actions.data(), reward.data(), done.data());
+        logSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - l0).count();
+        for (int i = 0; i < instances; ++i)
+            if (done[i]) env.autoReset(i);
+        for (int i = 0; i < instances; ++i) rewardSum += reward[i];
+    }
+    pool.stop();
+    if (!w.close()) return 1;
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    uint64_t rows = w.totalRows;
+    std::cout << rows << " rows in " << sec << " s, logging " << rows / logSec / 1e6 << " M rows/s on the sim thread, "
+              << w.stalls << " stalls\n";
+
+    MappedTrajectory m;
+    if (!mapTrajectory(path, m)) return 1;
+    uint64_t mappedRows = 0;
+    double mappedReward = 0.0;
+    for (uint64_t c = 0; c < m.numChunks; ++c) {
+        const float* rw = (const float*)m.column(c, TRAJ_REWARD);
+        uint32_t n = m.chunkHeader(c)->rows;
+        for (uint32_t k = 0; k < n; ++k) mappedReward += rw[k];
+        mappedRows += n;
+    }
+    unmapTrajectory(m);
+    bool ok = mappedRows == rows && mappedReward == rewardSum;
+    std::cout << "mapped " << mappedRows << " rows, reward sum " << mappedReward << (ok ? " (OK)" : " (MISMATCH)") << "\n";
+    return ok ? 0 : 1;
+}
+
+// --bench-sensors: cost per observatie (grila de ocupare + raze)
+void benchSensors(int instances, int ticks) {
+    BatchEnv env;
+    env.init(BatchConfig(), instances, 42);
+    std::vector<uint8_t> actions(instances, ACT_UP);
+    for (int t = 0; t < 300; ++t) env.step(actions.data(), nullptr, nullptr, nullptr);
+    SensorConfig cfg;
+    SensorScratch scratch;
+    std::vector<float> obs((size_t)observationSize(env, cfg) * instances);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) observeRange(env, 0, instances, cfg, scratch, obs.data());
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << observationSize(env, cfg) << " floats/obs, " << us / ((double)instances * ticks) << " us/obs\n";
+}
+
+// --bench-scaling: acelasi lot pe 1..toate core-urile, cu RolloutPool
+void benchScaling(int instances, int ticks) {
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+    double base = 0.0;
+    for (int t = 1; t <= maxThreads; ++t) {
+        BatchEnv env;
+        env.init(BatchConfig(), instances, 42);
+        RolloutPool pool;
+        pool.start(env, t);
+        pool.stepAll(nullptr, nullptr, nullptr, nullptr, true, 10); // warm-up
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < ticks; ++k) pool.stepAll(nullptr, nullptr, nullptr, nullptr, true);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double rate = (double)instances * ticks / sec;
+        if (t == 1) base = rate;
+        printf("%2d threads: %8.2f M steps/s  speedup %5.2fx  efficiency %3.0f%%\n", t, rate / 1e6, rate / base, 100.0 * rate / base / t);
+    }
+}
+
+// ------------------------- AUTOPILOT -------------------------
+// Beam search peste macro-actiuni. Lumea e determinista (Philox cu cheia rngSeed si
+// simTick), deci o instanta BatchEnv incarcata din starea globala prezice exact
+// viitorul pentru o secventa de actiuni. La fiecare nivel, fiecare stare din fascicul
+// se copiaza in AP_ACTIONS copii, fiecare copil tine actiunea lui AP_MACRO tick-uri,
+// iar cele mai bune AP_BEAM raman. Se joaca prima actiune a celei mai bune frunze.
+// O stare moarta din fascicul nu se mai extinde: trece ca un singur copil, neschimbata.
+#define AP_BEAM 48
+#define AP_DEPTH 6
+#define AP_MACRO 8
+#define AP_ACTIONS 7
+
+static const uint8_t apActions[AP_ACTIONS] = {
+    ACT_UP, ACT_UP | ACT_LEFT, ACT_UP | ACT_RIGHT, ACT_LEFT, ACT_RIGHT, 0, ACT_DOWN
+};
+
+struct AutopilotStats {
+    uint64_t decisions = 0, rollouts = 0;
+    double planMs = 0.0;
+};
+
+BatchEnv apBeam, apChildren;   // AP_BEAM stari / AP_BEAM * AP_ACTIONS copii
+RolloutPool apPool;
+AutopilotStats apStats;
+std::vector<uint8_t> apChildActions;
+std::vector<float> apValue;
+std::vector<int> apFirst, apBeamFirst, apOrder;
+
+// Supravietuirea conteaza mai mult decat orice scor; intre supravietuitori, scorul,
+// distanta parcursa si cat de aproape e cea mai apropiata moneda (dincolo de orizont).
+// tick[i] nu mai creste dupa game over, deci tick[i] - rootTick e momentul mortii.
+float autopilotValue(const BatchEnv& e, int i, float rootY, uint64_t rootTick) {
+    if (e.gameOver[i]) return -1e6f + (float)(e.tick[i] - rootTick) * 1e3f + e.score[i];
+    const float* rx = &e.rewardX[(size_t)i * e.rewardCapacity];
+    const float* ry = &e.rewardY[(size_t)i * e.rewardCapacity];
+    float nearest = 10.0f;
+    for (int k = 0; k < e.rewardCount[i]; ++k) {
+        float dy = ry[k] - e.playerY[i];
+        if (dy < 0.0f) continue;
+        float d = fabsf(rx[k] - e.playerX[i]) * 4.0f + dy;
+        if (d < nearest) nearest = d;
+    }
+    return e.score[i] * 100.0f + (e.playerY[i] - rootY) * 10.0f - nearest * 5.0f;
+}
+
+unsigned autopilotAction() {
+    auto t0 = std::chrono::steady_clock::now();
+    const int C = (int)aiCars.size(), N = AP_BEAM * AP_ACTIONS;
+    if (apBeam.carsPerInstance != C || apBeam.laneCenters.size() != laneCenters.size()) {
+        apPool.stop();
+        apBeam.init(configFromGlobals(), AP_BEAM, 0);
+        apChildren.init(configFromGlobals(), N, 0);
+        apPool.start(apChildren, (int)std::max(1u, std::thread::hardware_concurrency()));
+        apChildActions.assign(N, 0); apValue.assign(N, 0.0f);
+        apFirst.assign(N, 0); apBeamFirst.assign(AP_BEAM, 0); apOrder.resize(N);
+    }
+    loadInstanceFromGlobals(apBeam, 0);
+    loadInstanceFromGlobals(apChildren, 0);
+    const float rootY = playerY;
+    const uint64_t rootTick = apBeam.tick[0];
+    int beamSize = 1, best = 0;
+
+    for (int depth = 0; depth < AP_DEPTH; ++depth) {
+        int n = 0;
+        for (int b = 0; b < beamSize; ++b) {
+            if (apBeam.gameOver[b]) {
+                apChildren.copyInstance(apBeam, b, n);
+                apChildActions[n] = 0;
+                apFirst[n++] = apBeamFirst[b];
+                continue;
+            }
+            for (int a = 0; a < AP_ACTIONS; ++a, ++n) {
+                apChildren.copyInstance(apBeam, b, n);
+                apChildActions[n] = apActions[a];
+                apFirst[n] = depth == 0 ? a : apBeamFirst[b];
+            }
+        }
+        for (int k = n; k < N; ++k) apChildren.gameOver[k] = 1;  // sloturile nefolosite nu se simuleaza
+        apPool.stepAll(apChildActions.data(), nullptr, nullptr, nullptr, false, AP_MACRO);
+        apStats.rollouts += n;
+
+        for (int k = 0; k < n; ++k) { apValue[k] = autopilotValue(apChildren, k, rootY, rootTick); apOrder[k] = k; }
+        beamSize = std::min(n, AP_BEAM);
+        std::partial_sort(apOrder.begin(), apOrder.begin() + beamSize, apOrder.begin() + n,
+                          [](int x, int y) { return apValue[x] > apValue[y] || (apValue[x] == apValue[y] && x < y); });
+        best = apFirst[apOrder[0]];
+        for (int b = 0; b < beamSize; ++b) {
+            apBeam.copyInstance(apChildren, apOrder[b], b);
+            apBeamFirst[b] = apFirst[apOrder[b]];
+        }
+    }
+    apStats.decisions++;
+    apStats.planMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return apActions[best];
+}
+
+// --autopilot-soak [tick-uri] [seed]: autopilotul joaca fara fereastra.
+int runAutopilotSoak(int ticks, uint32_t seed) {
+    eventsEnabled = false;
+    initLanes(18, 18, 0.6f);
+    seedRandom(seed);
+    resetGame();
+    int t = 0;
+    for (; t < ticks && !gameOver; ++t) stepGame(autopilotAction());
+    std::cout << "autopilot: " << (gameOver ? "crashed" : "survived") << " after " << t << " ticks, score " << score
+              << ", " << apStats.planMs / std::max<uint64_t>(1, apStats.decisions) << " ms/decision, "
+              << apStats.rollouts / std::max<uint64_t>(1, apStats.decisions) << " rollouts/decision\n";
+    return gameOver ? 1 : 0;
+}
+
+// ------------------------- DIVERGENCE CHECK -------------------------
+// Ruleaza doua implementari ale lui stepGame() din aceeasi stare si cu
+// aceleasi actiuni si raporteaza primul tick + camp unde difera.
+// Ambele StepFn trebuie sa termine cu refreshStateHash(), ca stepGame().
+typedef void (*StepFn)(unsigned actions);
+
+struct DivergenceReport {
+    bool diverged;
+    uint64_t tick;
+    int field;
+};
+
+// Actiuni deterministe pentru harness (nu consuma din gen).
+unsigned scriptedActions(uint64_t tick) {
+    uint64_t h = fnv1a(14695981039346656037ull, &tick, sizeof(tick));
+    unsigned a = 0;
+    if ((h & 3) != 0) a |= ACT_UP;
+    if (((h >> 2) & 7) == 0) a |= ACT_DOWN;
+    if (((h >> 8) & 3) == 1) a |= ACT_LEFT;
+    if (((h >> 8) & 3) == 2) a |= ACT_RIGHT;
+    return a;
+}
+
+// false daca lumea de start nu incape in GameSnapshot
+bool beginRun(uint32_t seed, GameSnapshot& start) {
+    seedRandom(seed);
+    simTick = 0;
+    lineDashOffset = 0.0f;
+    camX = camY = 0.0f;
+    initLanes(laneNumLeft, laneNumRight, laneWidth);
+    resetGame();
+    return snapshot(start);
+}
+
+std::vector<StateHash> recordTrace(StepFn step, const GameSnapshot& start, int ticks) {
+    std::vector<StateHash> trace;
+    trace.reserve(ticks);
+    restore(start);
+    for (int t = 0; t < ticks; ++t) {
+        if (gameOver) resetGame();
+        step(scriptedActions(t));
+        trace.push_back(stateHash);
+    }
+    return trace;
+}
+
+DivergenceReport checkDivergence(StepFn reference, StepFn candidate, uint32_t seed, int ticks) {
+    static GameSnapshot start;
+    DivergenceReport rep = { false, 0, -1 };
+    stateHashEnabled = true;
+    if (!beginRun(seed, start)) { rep.diverged = true; return rep; }
+    std::vector<StateHash> ref = recordTrace(reference, start, ticks);
+    restore(start);
+    for (int t = 0; t < ticks; ++t) {
+        if (gameOver) resetGame();
+        candidate(scriptedActions(t));
+        const StateHash& h = stateHash;
+        if (h.combined == ref[t].combined) continue;
+        rep.diverged = true;
+        rep.tick = t;
+        for (int f = 0; f < HF_COUNT; ++f) if (h.field[f] != ref[t].field[f]) { rep.field = f; break; }
+        break;
+    }
+    return rep;
+}
+
+int runDivergenceCheck(const char* name, StepFn candidate, uint32_t seed, int ticks) {
+    DivergenceReport r = checkDivergence(stepGame, candidate, seed, ticks);
+    if (!r.diverged) {
+        std::cout << name << ": OK (" << ticks << " ticks, seed " << seed << ")\n";
+        return 0;
+    }
+    if (r.field < 0) {
+        std::cout << name << ": start state does not fit in GameSnapshot\n";
+        return 1;
+    }
+    std::cout << name << ": DIVERGED at tick " << r.tick << ", field " << hashFieldNames[r.field] << "\n";
+    return 1;
+}
+
+
+// ------------------------- VIEW CULLING -------------------------
+// Proiectia vede doar +-zoom*aspect x +-zoom in jurul camerei. Masinile si monedele
+// au cate un index sortat dupa y (permutare a indicilor din aiCars / rewards, care
+// isi pastreaza ordinea pentru simulare); desenarea ia doar felia vizibila cu
+// cautare binara. De la un cadru la altul ordinea se schimba putin, deci indexul
+// se repara prin insertie; dupa prea multe mutari (respawn-uri in masa) se sorteaza tot.
+struct ViewRect { float minX, maxX, minY, maxY; };
+
+std::vector<int> carsByY, rewardsByY;
+int visibleCars = 0, visibleRewards = 0;   // ultimul cadru
+
+template <class GetY>
+void updateYOrder(std::vector<int>& order, int n, GetY y) {
+    auto byY = [&](int a, int b) { return y(a) < y(b); };
+    if ((int)order.size() != n) {
+        order.resize(n);
+        for (int i = 0; i < n; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), byY);
+        return;
+    }
+    size_t budget = 4 * (size_t)n + 64;
+    for (int i = 1; i < n; ++i) {
+        const int v = order[i];
+        const float vy = y(v);
+        int j = i;
+        for (; j > 0 && y(order[j - 1]) > vy; --j) {
+            order[j] = order[j - 1];
+            if (--budget == 0) { order[j - 1] = v; std::sort(order.begin(), order.end(), byY); return; }
+        }
+        order[j] = v;
+    }
+}
+
+// Primul element din order cu y >= minY.
+template <class GetY>
+size_t firstAtOrAbove(const std::vector<int>& order, float minY, GetY y) {
+    return std::partition_point(order.begin(), order.end(), [&](int i) { return y(i) < minY; }) - order.begin();
+}
 
 // ------------------------- HUD / RENDER -------------------------
 void drawHUD(const Mat4& proj) {
-    char buf[64];
-    sprintf_s(buf, sizeof(buf), "Score: %d", score);
+    char buf[96];
+    sprintf_s(buf, sizeof(buf), autopilot ? "Score: %d  [AUTOPILOT]" : "Score: %d", score);
 
     int px = 10;
     int py = winH - 24;
 
-    glUseProgram(0);
+    // textul bitmap trece prin pipeline-ul fix; cadrul urmator isi leaga singur programul
+    glState.useProgram(0);
     glWindowPos2i(px, py);
     for (char* p = buf; *p; ++p) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
 
+    if (showRenderStats) {
+        sprintf_s(buf, sizeof(buf), "draws %d  state changes %d  skipped %d  cars %d/%d",
+                  renderDrawCalls, glState.lastChanges, glState.lastSkipped, visibleCars, (int)aiCars.size());
+        glWindowPos2i(px, py - 22);
+        for (char* p = buf; *p; ++p) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
+        sprintf_s(buf, sizeof(buf), "stream %s  fence waits %d  grows %d",
+                  streamBuffer.persistent ? "persistent" : "orphan", streamBuffer.waits, streamBuffer.grows);
+        glWindowPos2i(px, py - 44);
+        for (char* p = buf; *p; ++p) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
+    }
+
     if (gameOver) {
         const char msg[] = "GAME OVER! Press R to restart";
         int msgw = (int)strlen(msg) * 9;
@@ -435,75 +1629,235 @@ void drawHUD(const Mat4& proj) {
         glWindowPos2i(cx, cy);
         for (const char* p = msg; *p; ++p) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
     }
-    glUseProgram(ProgramId);
 }
 
 
 void renderScene() {
+    streamBuffer.beginFrame();
+    glState.beginFrame();
     glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(ProgramId);
 
     float aspect = (float)winW / (float)winH;
     float zoom = 2.0f;
     Mat4 proj = mat_ortho(-zoom * aspect, zoom * aspect, -zoom, zoom);
-    if (uProjLoc >= 0) glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, proj.m);
 
-    static float camX = 0.0f, camY = 0.0f;
     camX = camX * 0.9f + playerX * 0.1f;
     camY = camY * 0.9f + playerY * 0.1f;
 
-    if (!laneCenters.empty()) {
-        std::vector<float> verts;
-        verts.reserve((laneNumLeft + laneNumRight + 1) * 4);
-        float startY = camY - 4.0f;
-        float endY = camY + 12.0f;
-        int drawLeft = laneNumLeft;
-        int drawRight = laneNumRight;
-        for (int i = -drawLeft; i <= drawRight; ++i) {
-            float x = i * laneWidth;
-            verts.push_back(x - camX); verts.push_back(startY - camY);
-            verts.push_back(x - camX); verts.push_back(endY - camY);
-        }
-        float laneColor[4] = { 1.0f, 0.85f, 0.0f, 1.0f };
-        drawLines(verts, lineOffsets, laneColor, 5.0f);
-    }
+    const ViewRect view = { camX - zoom * aspect, camX + zoom * aspect, camY - zoom, camY + zoom };
 
-    for (auto& r : rewards) {
-        if (r.collected) continue;
-        drawTexturedQuad(r.x - camX, r.y - camY, 0.1f, 0.1f, 0.0f, rewardTexture);
+    // linia are cativa pixeli latime, o banda de margine ajunge
+    pushLaneLines(view.minX - laneWidth, view.maxX + laneWidth);
+
+    auto rewardY = [](int i) { return rewards[i].y; };
+    updateYOrder(rewardsByY, (int)rewards.size(), rewardY);
+    visibleRewards = 0;
+    for (size_t k = firstAtOrAbove(rewardsByY, view.minY - 0.05f, rewardY); k < rewardsByY.size(); ++k) {
+        const Reward& r = rewards[rewardsByY[k]];
+        if (r.y > view.maxY + 0.05f) break;
+        if (r.collected || r.x < view.minX - 0.05f || r.x > view.maxX + 0.05f) continue;
+        pushSprite(atlasTexture, r.x - camX, r.y - camY, 0.1f, 0.1f, 0.0f, coinSprite.uv);
+        ++visibleRewards;
     }
 
-    for (auto& c : aiCars) {
-        drawTexturedQuad(c.x - camX, c.y - camY, carWidth, carHeight, 0.0f, carTexture);
+    auto carY = [](int i) { return aiCars[i].y; };
+    updateYOrder(carsByY, (int)aiCars.size(), carY);
+    visibleCars = 0;
+    const float carMargin = 0.5f * std::max(carWidth, carHeight);
+    for (size_t k = firstAtOrAbove(carsByY, view.minY - carMargin, carY); k < carsByY.size(); ++k) {
+        const Car& c = aiCars[carsByY[k]];
+        if (c.y > view.maxY + carMargin) break;
+        if (c.x < view.minX - carMargin || c.x > view.maxX + carMargin) continue;
+        pushSprite(atlasTexture, c.x - camX, c.y - camY, carWidth, carHeight, 0.0f, carSprite.uv);
+        ++visibleCars;
     }
 
     if (!trail.empty()) {
         int n = (int)trail.size(), i = 0;
         for (auto& p : trail) {
             float t = (float)i / std::max(1, n - 1);
+            ++i;
+            if (p.first < view.minX - carWidth || p.first > view.maxX + carWidth ||
+                p.second < view.minY - carHeight || p.second > view.maxY + carHeight) continue;
             float alpha = 0.3f + 0.7f * t;
             float scale = 0.55f + 0.7f * t;
             float px = p.first - camX, py = p.second - camY;
             float w = (carWidth * 0.3f) * scale;
             float h = (carHeight * 0.25f) * scale;
             float col[4] = { 0.15f, 0.15f, 0.15f, alpha };
-            drawColoredQuad(px, py, w, h, 0.0f, col);
-            ++i;
+            pushColoredSprite(px, py, w, h, 0.0f, col, LAYER_TRAIL);
         }
     }
 
-    drawTexturedQuad(playerX - camX, playerY - camY, carWidth, carHeight, -rotSmooth, carTexture);
+    pushSprite(atlasTexture, playerX - camX, playerY - camY, carWidth, carHeight, -rotSmooth, carSprite.uv);
+
+    // tot ce scrie cadrul in streamBuffer, rezervat inainte de prima comanda
+    streamBuffer.reserve(StreamBuffer::frameBytes(lineInstances.size() * sizeof(float) +
+                                                  spriteInstances.size() * sizeof(SpriteInstance), 2));
+    float laneColor[4] = { 1.0f, 0.85f, 0.0f, 1.0f };
+    queueLaneLines(proj, -4.0f, 12.0f, laneColor, 5.0f);
+    queueSprites(proj);
+    submitRenderQueue();
 
     drawHUD(proj);
+    streamBuffer.endFrame();
 
-    glUseProgram(0);
     glutSwapBuffers();
 }
 
+// ------------------------- BATCHED PIXEL OBS -------------------------
+// Cand agentii au nevoie de pixeli: toate instantele unui BatchEnv intr-un
+// singur framebuffer offscreen, cate un tile patrat per instanta, centrat pe
+// jucator. Toate sprite-urile (masini, monede, jucator, linii) merg intr-un
+// singur glDrawArraysInstanced, urmat de un singur glReadPixels. Merge si pe
+// llvmpipe (LIBGL_ALWAYS_SOFTWARE=1). Compilat cu -DUSE_EGL nu are nevoie de X
+// (context EGL surfaceless); altfel o fereastra GLUT ascunsa da contextul.
+struct ObsSprite { float x, y, sx, sy; float tile, kind; };
+enum { OBS_CAR = 0, OBS_COIN = 1, OBS_LANE = 2 };
+
+GLuint obsProgram = 0;
+GLuint obsFBO = 0, obsColorRB = 0;
+GLuint obsVAO = 0, obsInstanceVBO = 0;
+GLint obsGridLoc = -1, obsHalfViewLoc = -1;
+int obsCols = 0, obsRows = 0, obsTile = 0;
+const float OBS_HALF_VIEW = 2.0f;
+std::vector<ObsSprite> obsSprites;
+
+bool initObsAtlas(int instances, int tileSize) {
+    obsTile = tileSize;
+    obsCols = (int)ceilf(sqrtf((float)instances));
+    obsRows = (instances + obsCols - 1) / obsCols;
+
+    obsProgram = loadShaderVariant("obsAtlas.vert", "obsAtlas.frag", "");
+    if (!obsProgram) return false;
+    glUseProgram(obsProgram);
+    obsGridLoc = glGetUniformLocation(obsProgram, "uGrid");
+    obsHalfViewLoc = glGetUniformLocation(obsProgram, "uHalfView");
+    glUniform1i(glGetUniformLocation(obsProgram, "uAtlas"), 0);
+    glUniform4fv(glGetUniformLocation(obsProgram, "uCarUV"), 1, carSprite.uv);
+    glUniform4fv(glGetUniformLocation(obsProgram, "uCoinUV"), 1, coinSprite.uv);
+    glUniform4f(glGetUniformLocation(obsProgram, "uLaneColor"), 1.0f, 0.85f, 0.0f, 1.0f);
+
+    glGenRenderbuffers(1, &obsColorRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, obsColorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, obsCols * obsTile, obsRows * obsTile);
+    glGenFramebuffers(1, &obsFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, obsFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, obsColorRB);
+    bool ok = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!ok) { std::cerr << "Observation framebuffer incomplete\n"; return false; }
+
+    // quad-ul comun (atribute 0/1) + atribute per instanta (2/3)
+    glGenVertexArrays(1, &obsVAO);
+    glBindVertexArray(obsVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glGenBuffers(1, &obsInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, obsInstanceVBO);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ObsSprite), (void*)0);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(ObsSprite), (void*)(4 * sizeof(float)));
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+    glState.invalidate();
+    return true;
+}
+
+inline void obsPush(float x, float y, float sx, float sy, int tile, int kind) {
+    // doar ce poate atinge tile-ul (restul e taiat oricum de gl_ClipDistance)
+    if (fabsf(x) - sx * 0.5f > OBS_HALF_VIEW || fabsf(y) - sy * 0.5f > OBS_HALF_VIEW) return;
+    ObsSprite s = { x, y, sx, sy, (float)tile, (float)kind };
+    obsSprites.push_back(s);
+}
+
+// Randeaza toate instantele si citeste atlasul (RGBA8, randurile de jos in sus).
+void renderObsAtlas(const BatchEnv& env, std::vector<unsigned char>& pixels) {
+    obsSprites.clear();
+    const float w = env.cfg.laneWidth, cw = env.cfg.carWidth, ch = env.cfg.carHeight;
+    const float lineW = 2.0f * OBS_HALF_VIEW / obsTile; // un pixel
+    for (int i = 0; i < env.numInstances; ++i) {
+        const float px = env.playerX[i], py = env.playerY[i];
+        for (int l = -env.cfg.laneNumLeft; l <= env.cfg.laneNumRight; ++l)
+            obsPush(l * w - px, 0.0f, lineW, 2.0f * OBS_HALF_VIEW, i, OBS_LANE);
+        const float* rx = &env.rewardX[(size_t)i * env.rewardCapacity];
+        const float* ry = &env.rewardY[(size_t)i * env.rewardCapacity];
+        for (int k = 0; k < env.rewardCount[i]; ++k) obsPush(rx[k] - px, ry[k] - py, 0.1f, 0.1f, i, OBS_COIN);
+        const float* cx = &env.carX[(size_t)i * env.carsPerInstance];
+        const float* cy = &env.carY[(size_t)i * env.carsPerInstance];
+        for (int k = 0; k < env.carsPerInstance; ++k) obsPush(cx[k] - px, cy[k] - py, cw, ch, i, OBS_CAR);
+        obsPush(0.0f, 0.0f, cw, ch, i, OBS_CAR);
+    }
+
+    int fbW = obsCols * obsTile, fbH = obsRows * obsTile;
+    glBindFramebuffer(GL_FRAMEBUFFER, obsFBO);
+    glViewport(0, 0, fbW, fbH);
+    glClear(GL_COLOR_BUFFER_BIT);
+    for (int c = 0; c < 4; ++c) glEnable(GL_CLIP_DISTANCE0 + c);
+
+    const float grid[2] = { (float)obsCols, (float)obsRows }, halfView[2] = { OBS_HALF_VIEW, OBS_HALF_VIEW };
+    glState.useProgram(obsProgram);
+    glState.uniform(obsGridLoc, grid, 2);
+    glState.uniform(obsHalfViewLoc, halfView, 2);
+    glState.bindTexture(atlasTexture);
+    glState.setBlend(true);
+
+    glState.bindVertexArray(obsVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, obsInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, obsSprites.size() * sizeof(ObsSprite), obsSprites.data(), GL_STREAM_DRAW);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)obsSprites.size());
+
+    pixels.resize((size_t)fbW * fbH * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, fbW, fbH, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    for (int c = 0; c < 4; ++c) glDisable(GL_CLIP_DISTANCE0 + c);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, winW, winH);
+}
+
+// --pixel-obs [instante] [tile px] [cadre] [atlas.ppm]
+int runPixelObs(int instances, int tileSize, int frames, const char* dumpPath) {
+    if (!initObsAtlas(instances, tileSize)) return 1;
+    reportProgramCache();
+    BatchEnv env;
+    env.init(BatchConfig(), instances, 42);
+    std::vector<uint8_t> actions(instances);
+    std::vector<unsigned char> pixels;
+    BlockRng r = makeBlockRng(7);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < instances; ++i) actions[i] = (uint8_t)(ACT_UP | (r.nextU32() & (ACT_LEFT | ACT_RIGHT)));
+        env.step(actions.data(), nullptr, nullptr, nullptr, true);
+        renderObsAtlas(env, pixels);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << instances << " instances, " << obsCols * obsTile << "x" << obsRows * obsTile << " atlas: "
+              << (frames ? ms / frames : 0.0) << " ms/pass (" << obsSprites.size() << " sprites)\n";
+
+    if (dumpPath) {
+        FILE* f = fopen(dumpPath, "wb");
+        if (!f) { std::cerr << "Cannot write " << dumpPath << "\n"; return 1; }
+        int fbW = obsCols * obsTile, fbH = obsRows * obsTile;
+        fprintf(f, "P6\n%d %d\n255\n", fbW, fbH);
+        for (int y = fbH - 1; y >= 0; --y)
+            for (int x = 0; x < fbW; ++x) fwrite(&pixels[((size_t)y * fbW + x) * 4], 1, 3, f);
+        fclose(f);
+    }
+    return 0;
+}
+
 // ------------------------- INPUT -------------------------
 void handleKeyDown(unsigned char key, int, int) {
     keyStates[key] = true;
     if (gameOver && (key == 'r' || key == 'R')) resetGame();
+    if (key == 'p' || key == 'P') autopilot = !autopilot;
+    if (key == 'i' || key == 'I') showRenderStats = !showRenderStats;
     if (key == 27) exit(0); // ESC
 }
 void handleKeyUp(unsigned char key, int, int) { keyStates[key] = false; }
@@ -512,6 +1866,75 @@ void handleSpecialUp(int key, int, int) { specialKeyStates[key] = false; }
 void reshape(int w, int h) { winW = w; winH = h; glViewport(0, 0, w, h); }
 
 // ------------------------- INIT -------------------------
+// Incarca car.png / coin.png in atlas si il urca. Daca lipsesc si !required
+// (--pixel-obs pe noduri fara imaginile jocului) pune blocuri de o singura culoare.
+bool loadSceneSprites(bool required) {
+    // load textures - adjust paths
+    int carId = loadSpriteImage("C:\\Users\\Mihai\\Downloads\\car.png");
+    if (carId < 0 && required) { std::cerr << "Failed to load car.png. Adjust path.\n"; return false; }
+    int coinId = loadSpriteImage("C:\\Users\\Mihai\\Downloads\\coin.png");
+    if (coinId < 0 && required) { std::cerr << "Failed to load coin.png. Adjust path.\n"; return false; }
+    const unsigned char carColor[4] = { 60, 110, 200, 255 }, coinColor[4] = { 240, 190, 40, 255 };
+    if (carId < 0) carId = spriteAtlas.add(carColor, 1, 1);
+    if (coinId < 0) coinId = spriteAtlas.add(coinColor, 1, 1);
+    atlasTexture = uploadSpriteAtlas();
+    if (atlasTexture == 0) return false;
+    spriteAtlas.uvRect(carId, carSprite.uv);
+    spriteAtlas.uvRect(coinId, coinSprite.uv);
+    return true;
+}
+
+#ifdef USE_EGL
+// Context GL fara fereastra si fara X: platforma surfaceless (Mesa) daca exista,
+// altfel display-ul implicit cu un pbuffer mic. Merge cu llvmpipe pe noduri fara GPU.
+bool createHeadlessContext() {
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    const char* ext = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (getPlatformDisplay && ext && strstr(ext, "EGL_MESA_platform_surfaceless"))
+        dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (dpy == EGL_NO_DISPLAY) dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor)) { std::cerr << "eglInitialize failed\n"; return false; }
+    if (!eglBindAPI(EGL_OPENGL_API)) { std::cerr << "EGL has no desktop OpenGL\n"; return false; }
+
+    const EGLint cfgAttr[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig cfg = nullptr;
+    EGLint n = 0;
+    eglChooseConfig(dpy, cfgAttr, &cfg, 1, &n);
+    const EGLint ctxAttr[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                               EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+    EGLContext ctx = eglCreateContext(dpy, n > 0 ? cfg : (EGLConfig)nullptr, EGL_NO_CONTEXT, ctxAttr);
+    if (ctx == EGL_NO_CONTEXT) { std::cerr << "eglCreateContext failed: 0x" << std::hex << eglGetError() << std::dec << "\n"; return false; }
+    // totul se deseneaza in FBO-ul atlasului, suprafata conteaza doar unde nu exista surfaceless
+    EGLSurface surf = EGL_NO_SURFACE;
+    if (n > 0) {
+        const EGLint pbAttr[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+        surf = eglCreatePbufferSurface(dpy, cfg, pbAttr);
+    }
+    if (!eglMakeCurrent(dpy, surf, surf, ctx)) { std::cerr << "eglMakeCurrent failed\n"; return false; }
+    return true;
+}
+#endif
+
+// Doar ce trebuie pentru --pixel-obs: fara shaderele scenei si fara imaginile jocului obligatorii.
+bool initPixelObsGL() {
+    glewExperimental = GL_TRUE;
+#ifdef USE_EGL
+    // glewInit() cere un display GLX; functiile GL se incarca si fara el
+    GLenum er = glewContextInit();
+#else
+    GLenum er = glewInit();
+#endif
+    if (er != GLEW_OK) { std::cerr << "GLEW init error: " << glewGetErrorString(er) << std::endl; return false; }
+    std::cout << "GL version: " << (const char*)glGetString(GL_VERSION) << std::endl;
+    glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    createQuad();
+    return loadSceneSprites(false);
+}
+
 void initGL() {
     glewExperimental = GL_TRUE;
     GLenum er = glewInit();
@@ -523,35 +1946,102 @@ void initGL() {
 
     createQuad();
     createLineBuffer();
-
-    // MODIFICARE: Am inlocuit createProgramFromStrings cu LoadShaders
-    // Am folosit numele de fisiere pe care le-ai mentionat tu.
-    ProgramId = LoadShaders("example.vert", "example.frag");
-    // Am adaugat glUseProgram aici, ca in exemplul tau
-    glUseProgram(ProgramId);
-
-    // uniform locations (exact names)
-    codColLocation = glGetUniformLocation(ProgramId, "codColShader");
-    codColVertLoc = glGetUniformLocation(ProgramId, "codColVert");
-    uProjLoc = glGetUniformLocation(ProgramId, "uProj");
-    uTexLoc = glGetUniformLocation(ProgramId, "uTex");
-    uColorLoc = glGetUniformLocation(ProgramId, "uColor");
-
-    if (codColLocation < 0) std::cerr << "Warning: codColShader uniform not found\n";
-    if (codColVertLoc < 0)  std::cerr << "Warning: codColVert uniform not found\n";
-
-    // load textures - adjust paths
-    carTexture = loadTexture("C:\\Users\\Mihai\\Downloads\\car.png");
-    if (carTexture == 0) { std::cerr << "Failed to load car.png. Adjust path.\n"; exit(1); }
-    rewardTexture = loadTexture("C:\\Users\\Mihai\\Downloads\\coin.png");
-    if (rewardTexture == 0) { std::cerr << "Failed to load coin.png. Adjust path.\n"; exit(1); }
+    createSpriteBuffers();
+    streamBuffer.create(1 << 20);
+
+    // programele specializate ale scenei (scene.vert / scene.frag)
+    spriteProgram = loadShaderVariant("scene.vert", "scene.frag", "#define SPRITE_TEXTURED\n");
+    solidProgram = loadShaderVariant("scene.vert", "scene.frag", "#define SPRITE_SOLID\n");
+    lineProgram = loadShaderVariant("scene.vert", "scene.frag", "#define LANE_LINE\n");
+    reportProgramCache();
+    if (!spriteProgram || !solidProgram || !lineProgram) { std::cerr << "Failed to build scene shaders.\n"; exit(1); }
+    glUseProgram(spriteProgram);
+    spriteProjLoc = glGetUniformLocation(spriteProgram, "uProj");
+    glUniform1i(glGetUniformLocation(spriteProgram, "uTex"), 0);
+    solidProjLoc = glGetUniformLocation(solidProgram, "uProj");
+    lineProjLoc = glGetUniformLocation(lineProgram, "uProj");
+    lineSpanLoc = glGetUniformLocation(lineProgram, "uSpan");
+    lineColorLoc = glGetUniformLocation(lineProgram, "uColor");
+    lineDashLoc = glGetUniformLocation(lineProgram, "uDash");
+
+    if (!loadSceneSprites(true)) exit(1);
+
+    glState.invalidate();
 
     initLanes(18, 18, 0.6f);
     resetGame();
+    eventListeners.push_back(logEvent);
 }
 
 // ------------------------- MAIN -------------------------
 int main(int argc, char** argv) {
+    // --make-checkpoint <fisier> <masini> <benzi pe fiecare parte> [tick-uri warm-up]: lume mare pentru benchmark
+    if (argc > 4 && strcmp(argv[1], "--make-checkpoint") == 0) {
+        eventsEnabled = false;
+        numAiCars = atoi(argv[3]);
+        int lanes = atoi(argv[4]);
+        int warmup = argc > 5 ? atoi(argv[5]) : 300;
+        initLanes(lanes, lanes, 0.6f);
+        resetGame();
+        for (int t = 0; t < warmup && !gameOver; ++t) stepGame(ACT_UP);
+        return saveCheckpoint(argv[2]) ? 0 : 1;
+    }
+    // --bench-batch [instante] [tick-uri]
+    if (argc > 1 && strcmp(argv[1], "--bench-batch") == 0) {
+        benchBatch(argc > 2 ? atoi(argv[2]) : 4096, argc > 3 ? atoi(argv[3]) : 1000);
+        return 0;
+    }
+    // --bench-sensors [instante] [tick-uri]
+    if (argc > 1 && strcmp(argv[1], "--bench-sensors") == 0) {
+        benchSensors(argc > 2 ? atoi(argv[2]) : 1024, argc > 3 ? atoi(argv[3]) : 100);
+        return 0;
+    }
+    // --bench-scaling [instante] [tick-uri]
+    if (argc > 1 && strcmp(argv[1], "--bench-scaling") == 0) {
+        benchScaling(argc > 2 ? atoi(argv[2]) : 16384, argc > 3 ? atoi(argv[3]) : 200);
+        return 0;
+    }
+    // --autopilot-soak [tick-uri] [seed]
+    if (argc > 1 && strcmp(argv[1], "--autopilot-soak") == 0)
+        return runAutopilotSoak(argc > 2 ? atoi(argv[2]) : 36000, argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 12345u);
+    // --bench-trajectory <fisier> [instante] [tick-uri]
+    if (argc > 2 && strcmp(argv[1], "--bench-trajectory") == 0)
+        return benchTrajectory(argv[2], argc > 3 ? atoi(argv[3]) : 4096, argc > 4 ? atoi(argv[4]) : 1000);
+    const char* checkpointPath = nullptr;
+    bool pixelObs = argc > 1 && strcmp(argv[1], "--pixel-obs") == 0;
+    if (argc > 2 && strcmp(argv[1], "--load-checkpoint") == 0) checkpointPath = argv[2];
+    if (argc > 2 && strcmp(argv[1], "--log-trajectory") == 0) {
+        if (!trajLog.open(argv[2])) return 1;
+        trajLogging = true;
+    }
+
+    // --check-divergence [ticks] [seed]: compara variantele lui stepGame() cu referinta, fara fereastra
+    if (argc > 1 && strcmp(argv[1], "--check-divergence") == 0) {
+        int ticks = argc > 2 ? atoi(argv[2]) : 20000;
+        uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 12345u;
+        eventsEnabled = false;
+        initLanes(18, 18, 0.6f);
+        int failed = 0;
+        failed += runDivergenceCheck("stepGame", stepGame, seed, ticks);
+        failed += runDivergenceCheck("BatchEnv", stepGameBatched, seed, ticks);
+        return failed ? 1 : 0;
+    }
+
+    // --pixel-obs [instante] [tile px] [cadre] [atlas.ppm]
+    if (pixelObs) {
+#ifdef USE_EGL
+        if (!createHeadlessContext()) return 1;
+#else
+        glutInit(&argc, argv);
+        glutInitDisplayMode(GLUT_RGBA);
+        glutCreateWindow("Infinite Lanes - pixel obs");
+        glutHideWindow();
+#endif
+        if (!initPixelObsGL()) return 1;
+        return runPixelObs(argc > 2 ? atoi(argv[2]) : 256, argc > 3 ? atoi(argv[3]) : 64,
+                           argc > 4 ? atoi(argv[4]) : 100, argc > 5 ? argv[5] : nullptr);
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
     glutInitWindowSize(winW, winH);
@@ -565,6 +2055,12 @@ int main(int argc, char** argv) {
     std::cout << "GL version: " << (const char*)glGetString(GL_VERSION) << std::endl;
 
     initGL();
+    if (checkpointPath) {
+        int t0 = glutGet(GLUT_ELAPSED_TIME);
+        if (!loadCheckpoint(checkpointPath)) return 1;
+        std::cout << "Loaded " << checkpointPath << " (" << aiCars.size() << " cars) in "
+                  << glutGet(GLUT_ELAPSED_TIME) - t0 << " ms" << std::endl;
+    }
 
     glutDisplayFunc(renderScene);
     glutIdleFunc(update);
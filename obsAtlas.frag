@@ -0,0 +1,9 @@
+#version 330 core
+in vec2 vUV;
+flat in int vKind;
+uniform sampler2D uAtlas;
+uniform vec4 uLaneColor;
+out vec4 fragColor;
+void main(){
+    fragColor = vKind == 2 ? uLaneColor : texture(uAtlas, vUV);
+}
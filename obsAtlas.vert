@@ -0,0 +1,26 @@
+#version 330 core
+layout(location=0) in vec2 inPos;
+layout(location=1) in vec2 inUV;
+layout(location=2) in vec4 iPosSize;   // x, y fata de jucator, sx, sy
+layout(location=3) in vec2 iTileKind;  // index instanta (tile), tip sprite
+uniform vec2 uGrid;      // coloane, randuri in atlas
+uniform vec2 uHalfView;  // jumatate din zona vizibila, in unitati de lume
+uniform vec4 uCarUV;     // dreptunghiurile UV din atlasul de sprite-uri
+uniform vec4 uCoinUV;
+out vec2 vUV;
+flat out int vKind;
+void main(){
+    vec2 local = (iPosSize.xy + inPos * iPosSize.zw) / uHalfView;
+    // taie ce iese din tile, ca sa nu intre in viewport-ul vecin
+    gl_ClipDistance[0] = 1.0 - local.x;
+    gl_ClipDistance[1] = 1.0 + local.x;
+    gl_ClipDistance[2] = 1.0 - local.y;
+    gl_ClipDistance[3] = 1.0 + local.y;
+    float col = mod(iTileKind.x, uGrid.x);
+    float row = floor(iTileKind.x / uGrid.x);
+    vec2 atlas = (vec2(col, row) + local * 0.5 + 0.5) / uGrid;
+    gl_Position = vec4(atlas * 2.0 - 1.0, 0.0, 1.0);
+    vKind = int(iTileKind.y);
+    vec4 r = vKind == 0 ? uCarUV : uCoinUV;
+    vUV = mix(r.xy, r.zw, inUV);
+}
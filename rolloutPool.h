@@ -0,0 +1,171 @@
+// rolloutPool.h - thread-uri persistente care impart instantele unui BatchEnv
+// Header-only, se pune langa main.cpp.
+//
+// Fiecare worker are o bucata fixa [begin, end) de instante, propriul flux RNG
+// (pentru politica aleatoare) si propriile statistici pe o linie de cache
+// separata. stepAll() publica o generatie noua, face bucata 0 pe thread-ul
+// apelant si asteapta ca toti workerii sa scada contorul pending. Workerii
+// fara treaba se invart putin pe generation, apoi dorm pe o variabila de
+// conditie (parkCv) pana la generatia urmatoare sau stop().
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "batchEnv.h"
+#include "fastRandom.h"
+#include "sensors.h"
+
+struct alignas(64) WorkerStats {
+    uint64_t steps = 0;
+    uint64_t episodes = 0;   // episoade terminate (done)
+    int64_t scoreSum = 0;    // scorul final al episoadelor terminate
+};
+
+struct RolloutPool {
+    // Ce are de facut fiecare worker la generatia curenta; scris doar de
+    // thread-ul apelant inainte sa incrementeze generation.
+    struct Job {
+        const uint8_t* actions;  // nullptr = actiuni aleatoare din fluxul workerului
+        float* reward;
+        uint8_t* done;
+        int32_t* score;
+        bool resetDone;          // reseteaza pe loc instantele terminate
+        int ticks;
+        float* observations;     // optional, observationSize() float-uri per instanta, dupa reset
+        const SensorConfig* sensors;
+    };
+
+    struct Shard {
+        int begin = 0, end = 0;
+        BlockRng rng;
+        std::vector<float> scratch;
+        std::vector<uint8_t> actions;   // actiunile aleatoare ale bucatii, [0, end - begin)
+        SensorScratch sensorScratch;
+        WorkerStats stats;
+    };
+
+    BatchEnv* env = nullptr;
+    std::vector<Shard> shards;           // shards[0] ruleaza pe thread-ul apelant
+    std::vector<std::thread> threads;
+    Job job = {};
+    alignas(64) std::atomic<uint64_t> generation{ 0 };
+    alignas(64) std::atomic<int> pending{ 0 };
+    alignas(64) std::atomic<bool> stopping{ false };
+    alignas(64) std::atomic<int> parked{ 0 };   // workeri care dorm (sau sunt pe cale) pe parkCv
+    std::mutex parkMutex;
+    std::condition_variable parkCv;
+
+    ~RolloutPool() { stop(); }
+
+    // Bucatile sunt multipli de 64 de instante, ca granitele sa cada pe linii de
+    // cache in iesirile cu un octet per instanta (done). Asta tine doar daca
+    // bufferul e aliniat la 64 B; std::vector nu garanteaza, deci doi workeri
+    // vecini pot imparti cel mult linia de la granita.
+    void start(BatchEnv& e, int numThreads, uint64_t seed = 1) {
+        stop();
+        env = &e;
+        if (numThreads < 1) numThreads = 1;
+        const int n = e.numInstances;
+        int perShard = (n + numThreads - 1) / numThreads;
+        perShard = (perShard + 63) & ~63;
+        shards.clear();
+        shards.resize(numThreads);
+        uint64_t x = seed;
+        for (int w = 0; w < numThreads; ++w) {
+            Shard& s = shards[w];
+            s.begin = std::min(n, w * perShard);
+            s.end = std::min(n, s.begin + perShard);
+            s.rng.seed(BlockRng::splitmix64(x));
+            s.scratch.assign(e.carsPerInstance, 0.0f);
+            s.actions.assign(s.end - s.begin, 0);
+        }
+        stopping.store(false);
+        generation.store(0);
+        for (int w = 1; w < numThreads; ++w) threads.emplace_back(&RolloutPool::workerLoop, this, w);
+    }
+
+    void stop() {
+        if (threads.empty()) return;
+        stopping.store(true);
+        wakeParked();
+        for (auto& t : threads) t.join();
+        threads.clear();
+    }
+
+    int numThreads() const { return (int)shards.size(); }
+
+    // Un tick (sau job.ticks) pe toate instantele; se intoarce cand toate bucatile au terminat.
+    void stepAll(const uint8_t* actions, float* reward, uint8_t* done, int32_t* score, bool resetDone = false, int ticks = 1,
+                 float* observations = nullptr, const SensorConfig* sensors = nullptr) {
+        job.actions = actions; job.reward = reward; job.done = done; job.score = score;
+        job.resetDone = resetDone; job.ticks = ticks;
+        job.observations = sensors ? observations : nullptr; job.sensors = sensors;
+        pending.store((int)threads.size(), std::memory_order_relaxed);
+        generation.fetch_add(1);
+        wakeParked();
+        runShard(0);
+        while (pending.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+    }
+
+    WorkerStats totals() const {
+        WorkerStats t;
+        for (auto& s : shards) { t.steps += s.stats.steps; t.episodes += s.stats.episodes; t.scoreSum += s.stats.scoreSum; }
+        return t;
+    }
+
+    void runShard(int w) {
+        Shard& s = shards[w];
+        if (s.begin >= s.end) return;
+        BatchEnv& e = *env;
+        for (int t = 0; t < job.ticks; ++t) {
+            const uint8_t* a = job.actions ? job.actions + s.begin : s.actions.data();
+            if (!job.actions)
+                for (int i = s.begin; i < s.end; ++i) s.actions[i - s.begin] = (uint8_t)(s.rng.nextU32() & 15u);
+            e.stepRange(s.begin, s.end, a, job.reward, job.done, job.score, s.scratch.data());
+            s.stats.steps += (uint64_t)(s.end - s.begin);
+            for (int i = s.begin; i < s.end; ++i) {
+                if (!e.gameOver[i]) continue;
+                if (!job.resetDone) continue;
+                s.stats.episodes += 1;
+                s.stats.scoreSum += e.score[i];
+                e.autoReset(i);
+            }
+        }
+        if (job.observations) observeRange(e, s.begin, s.end, *job.sensors, s.sensorScratch, job.observations);
+    }
+
+    // generation/stopping si parked sunt seq_cst: fie stepAll vede parked > 0
+    // si trezeste, fie workerul vede generatia noua inainte sa adoarma.
+    void wakeParked() {
+        if (parked.load() == 0) return;
+        { std::lock_guard<std::mutex> lock(parkMutex); }
+        parkCv.notify_all();
+    }
+
+    void workerLoop(int w) {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t g;
+            int spins = 0;
+            while ((g = generation.load(std::memory_order_acquire)) == seen) {
+                if (stopping.load(std::memory_order_acquire)) return;
+                if (++spins <= 256) continue;
+                if (spins <= 512) { std::this_thread::yield(); continue; }
+                std::unique_lock<std::mutex> lock(parkMutex);
+                parked.fetch_add(1);
+                parkCv.wait(lock, [&] { return generation.load() != seen || stopping.load(); });
+                parked.fetch_sub(1);
+                spins = 0;
+            }
+            seen = g;
+            runShard(w);
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+};
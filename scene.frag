@@ -0,0 +1,25 @@
+#version 330 core
+// Variantele sunt cele din scene.vert.
+out vec4 fragColor;
+#if defined(LANE_LINE)
+in float vDist;
+flat in float vPhase;
+uniform vec4 uColor;
+uniform vec2 uDash;  // lungimea liniutei, lungimea modelului (liniuta + pauza)
+void main(){
+    if(mod(vDist + vPhase, uDash.y) >= uDash.x) discard;
+    fragColor = uColor;
+}
+#elif defined(SPRITE_TEXTURED)
+in vec2 vUV;
+in vec4 vColor;
+uniform sampler2D uTex;
+void main(){
+    fragColor = texture(uTex, vUV) * vColor;
+}
+#else
+in vec4 vColor;
+void main(){
+    fragColor = vColor;
+}
+#endif
@@ -0,0 +1,38 @@
+#version 330 core
+// Un singur fisier pentru toate programele scenei; main.cpp adauga dupa #version
+// unul din SPRITE_TEXTURED, SPRITE_SOLID, LANE_LINE (loadShaderVariant).
+uniform mat4 uProj;
+#ifdef LANE_LINE
+layout(location=0) in vec2 iLine;  // x fata de camera, faza liniutelor (lineOffsets)
+uniform vec2 uSpan;                // y de inceput si de sfarsit, fata de camera
+out float vDist;
+flat out float vPhase;
+void main(){
+    // doua varfuri per linie (GL_LINES), o instanta per banda
+    float y = gl_VertexID == 0 ? uSpan.x : uSpan.y;
+    gl_Position = uProj * vec4(iLine.x, y, 0.0, 1.0);
+    vDist = y - uSpan.x;
+    vPhase = iLine.y;
+}
+#else
+layout(location=0) in vec2 inPos;
+layout(location=1) in vec2 inUV;
+layout(location=2) in vec4 iPosSize;  // centru x, y (fata de camera), latime, inaltime
+layout(location=3) in float iRot;     // grade, ca mat_rotateZ
+layout(location=4) in vec4 iUVRect;   // u0, v0, u1, v1
+layout(location=5) in vec4 iColor;    // inmultit cu texelul
+#ifdef SPRITE_TEXTURED
+out vec2 vUV;
+#endif
+out vec4 vColor;
+void main(){
+    float a = radians(iRot);
+    vec2 p = inPos * iPosSize.zw;
+    p = vec2(p.x * cos(a) - p.y * sin(a), p.x * sin(a) + p.y * cos(a));
+    gl_Position = uProj * vec4(iPosSize.xy + p, 0.0, 1.0);
+#ifdef SPRITE_TEXTURED
+    vUV = mix(iUVRect.xy, iUVRect.zw, inUV);
+#endif
+    vColor = iColor;
+}
+#endif
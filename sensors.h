@@ -0,0 +1,161 @@
+// sensors.h - observatii fara randare pentru instantele unui BatchEnv
+// Header-only, fara GL; se pune langa main.cpp.
+//
+// Pentru fiecare instanta:
+//   - grila de ocupare banda x distanta in fata jucatorului, pe doua canale
+//     (masini, monede), 1.0 daca celula contine cel putin o entitate;
+//   - un evantai de raze din pozitia jucatorului, cu distanta pana la cea mai
+//     apropiata masina (rayRange daca nu loveste nimic).
+// Masinile sunt intai sortate pe benzi (counting sort in scratch), asa ca o raza
+// testeaza doar benzile pe care le traverseaza. Testul raza-dreptunghi merge pe
+// cate 4 masini deodata cu SSE2 (cu varianta scalara cand nu exista SSE2).
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SENSORS_SSE2 1
+#endif
+
+#include "batchEnv.h"
+
+struct SensorConfig {
+    int distanceBins = 16;
+    float aheadMin = -1.0f, aheadMax = 7.0f;  // relativ la jucator, pe y
+    int numRays = 9;
+    float fanDegrees = 120.0f;                 // simetric fata de +y
+    float rayRange = 6.0f;
+};
+
+// Buffere refolosite intre apeluri (cate unul per thread).
+struct SensorScratch {
+    std::vector<int> laneStart;   // numLanes + 1
+    std::vector<int> laneFill;
+    std::vector<float> sortedX, sortedY;
+    std::vector<float> rayDx, rayDy;  // directiile razelor pentru rayFan grade
+    float rayFan = 0.0f;
+};
+
+inline int sensorLanes(const BatchEnv& env) { return (int)env.laneCenters.size(); }
+
+inline int observationSize(const BatchEnv& env, const SensorConfig& cfg) {
+    return 2 * sensorLanes(env) * cfg.distanceBins + cfg.numRays;
+}
+
+inline int sensorLaneOf(float x, float laneOrigin, float invLaneWidth, int lanes) {
+    int l = (int)floorf((x - laneOrigin) * invLaneWidth);
+    return l < 0 ? 0 : (l >= lanes ? lanes - 1 : l);
+}
+
+// Distanta minima de-a lungul razei (ox,oy)+t*(dx,dy) pana la dreptunghiurile
+// centrate in (xs[k],ys[k]) cu semi-dimensiuni (hw,hh); best ramane daca nu e mai aproape.
+inline float sensorRayMin(const float* xs, const float* ys, int n, float ox, float oy,
+                          float invDx, float invDy, float hw, float hh, float best) {
+    int k = 0;
+#ifdef SENSORS_SSE2
+    const __m128 vox = _mm_set1_ps(ox), voy = _mm_set1_ps(oy);
+    const __m128 vix = _mm_set1_ps(invDx), viy = _mm_set1_ps(invDy);
+    const __m128 vhw = _mm_set1_ps(hw), vhh = _mm_set1_ps(hh);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 vbest = _mm_set1_ps(best);
+    for (; k + 4 <= n; k += 4) {
+        __m128 cx = _mm_sub_ps(_mm_loadu_ps(xs + k), vox);
+        __m128 cy = _mm_sub_ps(_mm_loadu_ps(ys + k), voy);
+        __m128 tx1 = _mm_mul_ps(_mm_sub_ps(cx, vhw), vix), tx2 = _mm_mul_ps(_mm_add_ps(cx, vhw), vix);
+        __m128 ty1 = _mm_mul_ps(_mm_sub_ps(cy, vhh), viy), ty2 = _mm_mul_ps(_mm_add_ps(cy, vhh), viy);
+        __m128 tmin = _mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2));
+        __m128 tmax = _mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2));
+        tmin = _mm_max_ps(tmin, zero);
+        __m128 hit = _mm_cmple_ps(tmin, tmax);
+        __m128 cand = _mm_or_ps(_mm_and_ps(hit, tmin), _mm_andnot_ps(hit, vbest));
+        vbest = _mm_min_ps(vbest, cand);
+    }
+    float lanes4[4];
+    _mm_storeu_ps(lanes4, vbest);
+    for (int j = 0; j < 4; ++j) if (lanes4[j] < best) best = lanes4[j];
+#endif
+    for (; k < n; ++k) {
+        float cx = xs[k] - ox, cy = ys[k] - oy;
+        float tx1 = (cx - hw) * invDx, tx2 = (cx + hw) * invDx;
+        float ty1 = (cy - hh) * invDy, ty2 = (cy + hh) * invDy;
+        float tmin = fmaxf(fminf(tx1, tx2), fminf(ty1, ty2));
+        float tmax = fminf(fmaxf(tx1, tx2), fmaxf(ty1, ty2));
+        tmin = fmaxf(tmin, 0.0f);
+        if (tmin <= tmax && tmin < best) best = tmin;
+    }
+    return best;
+}
+
+// Observatia instantei i in out[0 .. observationSize()).
+inline void observe(const BatchEnv& env, int i, const SensorConfig& cfg, SensorScratch& s, float* out) {
+    const int L = sensorLanes(env), B = cfg.distanceBins, C = env.carsPerInstance;
+    const float w = env.cfg.laneWidth;
+    const float laneOrigin = -env.cfg.laneNumLeft * w, invW = 1.0f / w;
+    const float px = env.playerX[i], py = env.playerY[i];
+    const float binScale = B / (cfg.aheadMax - cfg.aheadMin);
+    const float* cx = &env.carX[(size_t)i * C];
+    const float* cy = &env.carY[(size_t)i * C];
+
+    // sortare pe benzi
+    s.laneStart.assign(L + 1, 0);
+    s.sortedX.resize(C); s.sortedY.resize(C);
+    for (int k = 0; k < C; ++k) s.laneStart[sensorLaneOf(cx[k], laneOrigin, invW, L) + 1]++;
+    for (int l = 0; l < L; ++l) s.laneStart[l + 1] += s.laneStart[l];
+    s.laneFill.assign(s.laneStart.begin(), s.laneStart.end() - 1);
+    for (int k = 0; k < C; ++k) {
+        int d = s.laneFill[sensorLaneOf(cx[k], laneOrigin, invW, L)]++;
+        s.sortedX[d] = cx[k]; s.sortedY[d] = cy[k];
+    }
+
+    // grila de ocupare
+    float* carGrid = out;
+    float* coinGrid = out + L * B;
+    memset(out, 0, sizeof(float) * 2 * L * B);
+    for (int l = 0; l < L; ++l) {
+        for (int k = s.laneStart[l]; k < s.laneStart[l + 1]; ++k) {
+            float b = (s.sortedY[k] - py - cfg.aheadMin) * binScale;
+            if (b >= 0.0f && b < (float)B) carGrid[l * B + (int)b] = 1.0f;
+        }
+    }
+    const float* rx = &env.rewardX[(size_t)i * env.rewardCapacity];
+    const float* ry = &env.rewardY[(size_t)i * env.rewardCapacity];
+    for (int k = 0; k < env.rewardCount[i]; ++k) {
+        float b = (ry[k] - py - cfg.aheadMin) * binScale;
+        if (b >= 0.0f && b < (float)B) coinGrid[sensorLaneOf(rx[k], laneOrigin, invW, L) * B + (int)b] = 1.0f;
+    }
+
+    // evantai de raze
+    float* rays = out + 2 * L * B;
+    const float hw = env.cfg.carWidth * 0.5f, hh = env.cfg.carHeight * 0.5f;
+    if ((int)s.rayDx.size() != cfg.numRays || s.rayFan != cfg.fanDegrees) {
+        s.rayDx.resize(cfg.numRays); s.rayDy.resize(cfg.numRays); s.rayFan = cfg.fanDegrees;
+        for (int r = 0; r < cfg.numRays; ++r) {
+            float t = cfg.numRays > 1 ? (float)r / (cfg.numRays - 1) : 0.5f;
+            float ang = (t - 0.5f) * cfg.fanDegrees * 3.14159265f / 180.0f;
+            s.rayDx[r] = sinf(ang); s.rayDy[r] = cosf(ang);
+        }
+    }
+    for (int r = 0; r < cfg.numRays; ++r) {
+        float dx = s.rayDx[r], dy = s.rayDy[r];
+        float invDx = fabsf(dx) > 1e-6f ? 1.0f / dx : 1e30f;
+        float invDy = fabsf(dy) > 1e-6f ? 1.0f / dy : 1e30f;
+        // benzile atinse de raza (plus latimea masinii)
+        float xEnd = px + dx * cfg.rayRange;
+        int l0 = sensorLaneOf(fminf(px, xEnd) - hw, laneOrigin, invW, L);
+        int l1 = sensorLaneOf(fmaxf(px, xEnd) + hw, laneOrigin, invW, L);
+        float best = cfg.rayRange;
+        int k0 = s.laneStart[l0], k1 = s.laneStart[l1 + 1];
+        best = sensorRayMin(s.sortedX.data() + k0, s.sortedY.data() + k0, k1 - k0, px, py, invDx, invDy, hw, hh, best);
+        rays[r] = best;
+    }
+}
+
+// Observatiile instantelor [begin, end), cu pas observationSize() in out.
+inline void observeRange(const BatchEnv& env, int begin, int end, const SensorConfig& cfg, SensorScratch& s, float* out) {
+    const int stride = observationSize(env, cfg);
+    for (int i = begin; i < end; ++i) observe(env, i, cfg, s, out + (size_t)i * stride);
+}
@@ -0,0 +1,138 @@
+// shardProtocol.h - protocolul binar coordonator <-> worker (TCP), vezi coordinator.cpp
+// Header-only, POSIX sockets (Linux/macOS).
+//
+// Fiecare mesaj = ShardMsgHeader + payload de `bytes` octeti, little-endian, fara padding:
+//   HELLO   coord -> worker  ShardHello                     (porneste un il_env nou)
+//   READY   worker -> coord  ShardReady
+//   STEP    coord -> worker  actions[n]                     (un tick pentru toate instantele)
+//   RESET   coord -> worker  -
+//   RESULT  worker -> coord  rewards[n] f32, scores[n] i32,
+//                            observations[n * obsSize] f32 (doar daca HELLO le-a cerut), dones[n] u8
+//   BYE     coord -> worker  -
+// Workerul raspunde in ordinea cererilor, cu acelasi seq; coordonatorul poate avea
+// mai multe cereri in zbor pe aceeasi conexiune (pipelining).
+#pragma once
+
+#ifdef _WIN32
+#error "shardProtocol.h uses POSIX sockets"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define SHARD_MAGIC 0x494c5450u  // "ILTP"
+#define SHARD_VERSION 1
+
+enum ShardMsgType : uint32_t {
+    SHARD_HELLO = 1, SHARD_READY, SHARD_STEP, SHARD_RESET, SHARD_RESULT, SHARD_BYE
+};
+
+#pragma pack(push, 1)
+struct ShardMsgHeader {
+    uint32_t type;
+    uint32_t seq;
+    uint32_t bytes;  // marimea payload-ului
+};
+
+struct ShardHello {
+    uint32_t magic, version;
+    int32_t numInstances, numThreads;
+    int32_t numAiCars, lanesLeft, lanesRight;
+    int32_t autoReset, sendObservations;
+    uint64_t seed;
+};
+
+struct ShardReady {
+    uint32_t magic, version;
+    int32_t numInstances, obsSize;
+};
+#pragma pack(pop)
+
+inline uint64_t shardResultBytes(int n, int obsSize, bool observations) {
+    uint64_t b = (uint64_t)n * (sizeof(float) + sizeof(int32_t) + 1);
+    if (observations) b += (uint64_t)n * obsSize * sizeof(float);
+    return b;
+}
+
+// ------------------------- SOCKETS -------------------------
+inline bool shardSendAll(int fd, const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t k = send(fd, p, len, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k; len -= (size_t)k;
+    }
+    return true;
+}
+
+inline bool shardRecvAll(int fd, void* data, size_t len) {
+    char* p = (char*)data;
+    while (len > 0) {
+        ssize_t k = recv(fd, p, len, 0);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return false;
+        p += k; len -= (size_t)k;
+    }
+    return true;
+}
+
+inline bool shardSendMsg(int fd, uint32_t type, uint32_t seq, const void* payload, uint32_t bytes) {
+    ShardMsgHeader h = { type, seq, bytes };
+    return shardSendAll(fd, &h, sizeof(h)) && (bytes == 0 || shardSendAll(fd, payload, bytes));
+}
+
+inline void shardNoDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// Asculta pe port (0 = ales de kernel); *boundPort primeste portul real.
+inline int shardListen(uint16_t port, uint16_t* boundPort) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_ANY);
+    a.sin_port = htons(port);
+    socklen_t len = sizeof(a);
+    if (bind(fd, (sockaddr*)&a, sizeof(a)) != 0 || listen(fd, 4) != 0 || getsockname(fd, (sockaddr*)&a, &len) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (boundPort) *boundPort = ntohs(a.sin_port);
+    return fd;
+}
+
+// "host:port" -> socket conectat, -1 la eroare.
+inline int shardConnect(const char* hostPort) {
+    char host[256];
+    const char* colon = strrchr(hostPort, ':');
+    if (!colon || (size_t)(colon - hostPort) >= sizeof(host)) return -1;
+    memcpy(host, hostPort, colon - hostPort);
+    host[colon - hostPort] = 0;
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, colon + 1, &hints, &res) != 0) return -1;
+    int fd = -1;
+    for (addrinfo* r = res; r; r = r->ai_next) {
+        fd = socket(r->ai_family, r->ai_socktype, r->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, r->ai_addr, r->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) shardNoDelay(fd);
+    return fd;
+}
@@ -0,0 +1,137 @@
+// textureAtlas.h - impacheteaza imagini RGBA intr-un singur atlas (skyline bottom-left)
+// Header-only, fara GL; se pune langa main.cpp. Upload-ul il face apelantul.
+//
+// add() copiaza imaginea si intoarce un id; build() alege cel mai mic atlas
+// patrat putere a lui 2 in care incap toate (cele mai inalte primele) si scrie
+// pixelii. Fiecare imagine are `padding` pixeli in jur, umpluti cu marginea ei
+// (extrudare), ca filtrarea GL_LINEAR sa nu ia culori de la vecini.
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+struct AtlasRect { int x, y, w, h; };
+
+// Skyline: lista de segmente orizontale (x, y, w) care acopera latimea atlasului.
+struct SkylinePacker {
+    struct Node { int x, y, w; };
+    int width = 0, height = 0;
+    std::vector<Node> skyline;
+
+    void reset(int w, int h) {
+        width = w; height = h;
+        skyline.assign(1, Node{ 0, 0, w });
+    }
+
+    // Inaltimea la care incape un dreptunghi w x h incepand cu segmentul i, -1 daca nu incape.
+    int fitAt(size_t i, int w, int h) const {
+        int x = skyline[i].x;
+        if (x + w > width) return -1;
+        int y = 0, left = w;
+        for (size_t j = i; left > 0; ++j) {
+            if (j >= skyline.size()) return -1;
+            y = std::max(y, skyline[j].y);
+            if (y + h > height) return -1;
+            left -= skyline[j].w;
+        }
+        return y;
+    }
+
+    // Pozitia cea mai joasa (apoi cea mai din stanga); false daca nu mai e loc.
+    bool pack(int w, int h, AtlasRect& out) {
+        int bestY = -1; size_t bestI = 0;
+        for (size_t i = 0; i < skyline.size(); ++i) {
+            int y = fitAt(i, w, h);
+            if (y >= 0 && (bestY < 0 || y < bestY)) { bestY = y; bestI = i; }
+        }
+        if (bestY < 0) return false;
+        out = AtlasRect{ skyline[bestI].x, bestY, w, h };
+
+        // noul segment inlocuieste tot ce acopera
+        Node n = { out.x, bestY + h, w };
+        skyline.insert(skyline.begin() + bestI, n);
+        for (size_t j = bestI + 1; j < skyline.size();) {
+            Node& s = skyline[j];
+            int shrink = n.x + n.w - s.x;
+            if (shrink <= 0) break;
+            if (shrink >= s.w) { skyline.erase(skyline.begin() + j); continue; }
+            s.x += shrink; s.w -= shrink;
+            break;
+        }
+        // uneste segmentele vecine de aceeasi inaltime
+        for (size_t j = 0; j + 1 < skyline.size();) {
+            if (skyline[j].y == skyline[j + 1].y) { skyline[j].w += skyline[j + 1].w; skyline.erase(skyline.begin() + j + 1); }
+            else ++j;
+        }
+        return true;
+    }
+};
+
+struct TextureAtlas {
+    struct Image { int w, h; std::vector<unsigned char> rgba; AtlasRect rect; };
+    std::vector<Image> images;
+    int padding = 2;
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;   // RGBA8, width x height, dupa build()
+
+    int add(const unsigned char* rgba, int w, int h) {
+        Image im;
+        im.w = w; im.h = h;
+        im.rgba.assign(rgba, rgba + (size_t)w * h * 4);
+        im.rect = AtlasRect{ 0, 0, w, h };
+        images.push_back(im);
+        return (int)images.size() - 1;
+    }
+
+    bool build(int maxSize = 8192) {
+        std::vector<int> order(images.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            return images[a].h != images[b].h ? images[a].h > images[b].h : images[a].w > images[b].w;
+        });
+        int64_t area = 0;
+        for (const Image& im : images) area += (int64_t)(im.w + 2 * padding) * (im.h + 2 * padding);
+        int size = 64;
+        while ((int64_t)size * size < area) size *= 2;
+
+        for (; size <= maxSize; size *= 2) {
+            SkylinePacker packer;
+            packer.reset(size, size);
+            bool ok = true;
+            for (int i : order) {
+                AtlasRect r;
+                if (!packer.pack(images[i].w + 2 * padding, images[i].h + 2 * padding, r)) { ok = false; break; }
+                images[i].rect = AtlasRect{ r.x + padding, r.y + padding, images[i].w, images[i].h };
+            }
+            if (!ok) continue;
+            width = height = size;
+            pixels.assign((size_t)size * size * 4, 0);
+            for (const Image& im : images) blit(im);
+            return true;
+        }
+        return false;
+    }
+
+    // UV-urile imaginii id: u0, v0, u1, v1 (randul 0 al imaginii la v0).
+    void uvRect(int id, float uv[4]) const {
+        const AtlasRect& r = images[id].rect;
+        uv[0] = (float)r.x / width; uv[1] = (float)r.y / height;
+        uv[2] = (float)(r.x + r.w) / width; uv[3] = (float)(r.y + r.h) / height;
+    }
+
+private:
+    // Imaginea plus marginea extrudata pe `padding` pixeli.
+    void blit(const Image& im) {
+        const AtlasRect& r = im.rect;
+        for (int y = -padding; y < im.h + padding; ++y) {
+            int sy = std::min(std::max(y, 0), im.h - 1);
+            unsigned char* dst = &pixels[((size_t)(r.y + y) * width + r.x - padding) * 4];
+            for (int x = -padding; x < im.w + padding; ++x, dst += 4) {
+                int sx = std::min(std::max(x, 0), im.w - 1);
+                memcpy(dst, &im.rgba[((size_t)sy * im.w + sx) * 4], 4);
+            }
+        }
+    }
+};
@@ -0,0 +1,361 @@
+// trajectoryWriter.h - jurnal coloanar (stare, actiune, recompensa) pentru rollout-uri lungi
+// Header-only, fara GL; se pune langa main.cpp.
+//
+// Layout (little-endian, versionat):
+//   [TrajectoryHeader, TRAJ_BLOCK bytes]
+//   chunk 0, chunk 1, ...   fiecare de chunkBytes (multiplu de TRAJ_BLOCK):
+//     [TrajectoryChunkHeader, 64 bytes] + coloanele, fiecare la columnOffset[c]
+//     in chunk, aliniata la 64, cu loc pentru chunkRows randuri
+// Toate chunk-urile au acelasi layout (doar ultimul poate avea rows < chunkRows),
+// deci randul r e in chunk-ul r / chunkRows si se citeste direct din mmap.
+//
+// Scrierea: append() pune randul in chunk-ul curent (o scriere per coloana); cand
+// chunk-ul e plin, il preia thread-ul de fundal, care il scrie cu un singur fwrite.
+// Exista TRAJ_BUFFERS chunk-uri in rotatie; simularea asteapta doar daca toate sunt
+// in coada de scriere (contorul stalls), nu se pierde niciun rand.
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "batchEnv.h"
+
+#define TRAJ_MAGIC "ILTRAJ\0"
+#define TRAJ_VERSION 1
+#define TRAJ_BLOCK 4096
+#define TRAJ_BUFFERS 4
+#define TRAJ_NEAR 3   // distante: masina din fata pe banda, cea din spate, cea mai apropiata
+
+enum TrajectoryColumn {
+    TRAJ_TICK,          // uint64
+    TRAJ_INSTANCE,      // uint32
+    TRAJ_PLAYER_X, TRAJ_PLAYER_Y, TRAJ_ROT, TRAJ_SPEED, TRAJ_DRIFT,  // float
+    TRAJ_SCORE,         // int32
+    TRAJ_REWARD,        // float
+    TRAJ_ACTION,        // uint8 (ACT_*)
+    TRAJ_DONE,          // uint8
+    TRAJ_NEAR_CARS,     // float[TRAJ_NEAR]
+    TRAJ_NUM_COLUMNS
+};
+
+static const uint32_t trajColumnWidth[TRAJ_NUM_COLUMNS] = {
+    8, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 4 * TRAJ_NEAR
+};
+
+struct TrajectoryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;    // TRAJ_BLOCK, chunk-urile incep aici
+    uint32_t numColumns;
+    uint32_t chunkRows;
+    uint64_t chunkBytes;
+    uint64_t numChunks;     // 0 pana la close(); cititorul foloseste atunci marimea fisierului
+    uint64_t totalRows;
+    uint32_t columnWidth[TRAJ_NUM_COLUMNS];
+    uint32_t columnOffset[TRAJ_NUM_COLUMNS];
+    uint8_t reserved[256 - 48 - 8 * TRAJ_NUM_COLUMNS];
+};
+static_assert(sizeof(TrajectoryHeader) == 256, "TrajectoryHeader must stay 256 bytes");
+
+struct TrajectoryChunkHeader {
+    uint64_t firstRow;
+    uint32_t rows;
+    uint8_t reserved[52];
+};
+static_assert(sizeof(TrajectoryChunkHeader) == 64, "TrajectoryChunkHeader must stay 64 bytes");
+
+struct TrajectoryRow {
+    uint64_t tick;
+    uint32_t instance;
+    float playerX, playerY, rot, speed, drift;
+    int32_t score;
+    float reward;
+    uint8_t action, done;
+    float nearCars[TRAJ_NEAR];
+};
+
+inline uint64_t trajAlign(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+inline void trajLayout(TrajectoryHeader& h, uint32_t chunkRows) {
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TRAJ_MAGIC, 8);
+    h.version = TRAJ_VERSION;
+    h.headerSize = TRAJ_BLOCK;
+    h.numColumns = TRAJ_NUM_COLUMNS;
+    h.chunkRows = chunkRows;
+    uint64_t pos = sizeof(TrajectoryChunkHeader);
+    for (int c = 0; c < TRAJ_NUM_COLUMNS; ++c) {
+        h.columnWidth[c] = trajColumnWidth[c];
+        h.columnOffset[c] = (uint32_t)pos;
+        pos = trajAlign(pos + (uint64_t)chunkRows * trajColumnWidth[c], 64);
+    }
+    h.chunkBytes = trajAlign(pos, TRAJ_BLOCK);
+}
+
+// Distantele TRAJ_NEAR pentru un jucator in (px, py): pe y pana la cea mai apropiata
+// masina din fata / din spate care se suprapune pe x (laneHalf), apoi euclidian pana
+// la cea mai apropiata. range daca nu exista.
+inline void trajNearestCars(float px, float py, float laneHalf, const float* xs, const float* ys, int n,
+                            float range, float out[TRAJ_NEAR]) {
+    float ahead = range, behind = range, nearest2 = range * range;
+    for (int k = 0; k < n; ++k) {
+        float dx = xs[k] - px, dy = ys[k] - py;
+        float d2 = dx * dx + dy * dy;
+        if (d2 < nearest2) nearest2 = d2;
+        if (fabsf(dx) < laneHalf) {
+            if (dy >= 0.0f) { if (dy < ahead) ahead = dy; }
+            else if (-dy < behind) behind = -dy;
+        }
+    }
+    out[0] = ahead; out[1] = behind; out[2] = sqrtf(nearest2);
+}
+
+inline void* trajAlignedAlloc(size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, TRAJ_BLOCK);
+#else
+    return aligned_alloc(TRAJ_BLOCK, bytes);
+#endif
+}
+
+inline void trajAlignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// ------------------------- WRITER -------------------------
+struct TrajectoryWriter {
+    TrajectoryHeader header = {};
+    FILE* file = nullptr;
+    char* chunk = nullptr;        // chunk-ul in care scrie append()
+    char* col[TRAJ_NUM_COLUMNS] = {};
+    uint32_t rows = 0;            // randuri in chunk-ul curent
+    uint64_t totalRows = 0;
+    uint64_t stalls = 0;          // de cate ori a asteptat simularea dupa disc
+    std::atomic<bool> ioError{ false };
+
+    std::vector<char*> freeChunks, fullChunks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread flusher;
+
+    bool open(const char* path, uint32_t chunkRows = 65536) {
+        trajLayout(header, chunkRows);
+        file = fopen(path, "wb");
+        if (!file) { fprintf(stderr, "trajectory: cannot open %s for writing\n", path); return false; }
+        std::vector<char> first(TRAJ_BLOCK, 0);
+        memcpy(first.data(), &header, sizeof(header));
+        if (fwrite(first.data(), 1, TRAJ_BLOCK, file) != TRAJ_BLOCK) { fclose(file); file = nullptr; return false; }
+        for (int b = 0; b < TRAJ_BUFFERS; ++b) {
+            char* p = (char*)trajAlignedAlloc((size_t)header.chunkBytes);
+            if (!p) break;
+            memset(p, 0, (size_t)header.chunkBytes);
+            freeChunks.push_back(p);
+        }
+        if (freeChunks.empty()) {   // nextChunk() ar astepta la nesfarsit
+            fprintf(stderr, "trajectory: cannot allocate %llu-byte chunks\n", (unsigned long long)header.chunkBytes);
+            fclose(file); file = nullptr;
+            return false;
+        }
+        stopping = false;
+        ioError = false;
+        rows = 0; totalRows = 0; stalls = 0;
+        chunk = nullptr;
+        nextChunk();
+        flusher = std::thread([this] { flushLoop(); });
+        return true;
+    }
+
+    void append(const TrajectoryRow& r) {
+        memcpy(col[TRAJ_TICK] + rows * 8, &r.tick, 8);
+        memcpy(col[TRAJ_INSTANCE] + rows * 4, &r.instance, 4);
+        memcpy(col[TRAJ_PLAYER_X] + rows * 4, &r.playerX, 4);
+        memcpy(col[TRAJ_PLAYER_Y] + rows * 4, &r.playerY, 4);
+        memcpy(col[TRAJ_ROT] + rows * 4, &r.rot, 4);
+        memcpy(col[TRAJ_SPEED] + rows * 4, &r.speed, 4);
+        memcpy(col[TRAJ_DRIFT] + rows * 4, &r.drift, 4);
+        memcpy(col[TRAJ_SCORE] + rows * 4, &r.score, 4);
+        memcpy(col[TRAJ_REWARD] + rows * 4, &r.reward, 4);
+        col[TRAJ_ACTION][rows] = r.action;
+        col[TRAJ_DONE][rows] = r.done;
+        memcpy(col[TRAJ_NEAR_CARS] + rows * 4 * TRAJ_NEAR, r.nearCars, 4 * TRAJ_NEAR);
+        if (++rows == header.chunkRows) submitChunk();
+    }
+
+    // Toate instantele unui BatchEnv dupa un pas (cate un rand per instanta).
+    void appendBatch(const BatchEnv& env, const uint8_t* actions, const float* reward, const uint8_t* done) {
+        const int C = env.carsPerInstance;
+        const float laneHalf = env.cfg.laneWidth * 0.5f;
+        TrajectoryRow r;
+        for (int i = 0; i < env.numInstances; ++i) {
+            r.tick = env.tick[i]; r.instance = (uint32_t)i;
+            r.playerX = env.playerX[i]; r.playerY = env.playerY[i]; r.rot = env.rotSmooth[i];
+            r.speed = env.playerSpeed[i]; r.drift = env.drift[i];
+            r.score = env.score[i]; r.reward = reward ? reward[i] : 0.0f;
+            r.action = actions ? actions[i] : 0; r.done = done ? done[i] : env.gameOver[i];
+            trajNearestCars(r.playerX, r.playerY, laneHalf, &env.carX[(size_t)i * C], &env.carY[(size_t)i * C], C,
+                            env.cfg.aiSpawnAheadMax, r.nearCars);
+            append(r);
+        }
+    }
+
+    // Scrie chunk-ul partial, header-ul final si opreste thread-ul de fundal.
+    bool close() {
+        if (!file) return false;
+        if (rows > 0) submitChunk();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        flusher.join();
+        if (chunk) freeChunks.push_back(chunk);
+        chunk = nullptr;
+        header.totalRows = totalRows;
+        header.numChunks = (totalRows + header.chunkRows - 1) / header.chunkRows;
+        bool ok = !ioError && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+        if (fclose(file) != 0) ok = false;
+        file = nullptr;
+        for (char* p : freeChunks) trajAlignedFree(p);
+        freeChunks.clear();
+        if (!ok) fprintf(stderr, "trajectory: write failed\n");
+        return ok;
+    }
+
+    ~TrajectoryWriter() { if (file) close(); }
+
+private:
+    void nextChunk() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (freeChunks.empty()) {
+            ++stalls;
+            cv.wait(lock, [this] { return !freeChunks.empty(); });
+        }
+        chunk = freeChunks.back();
+        freeChunks.pop_back();
+        lock.unlock();
+        for (int c = 0; c < TRAJ_NUM_COLUMNS; ++c) col[c] = chunk + header.columnOffset[c];
+        rows = 0;
+    }
+
+    void submitChunk() {
+        TrajectoryChunkHeader ch = {};
+        ch.firstRow = totalRows;
+        ch.rows = rows;
+        memcpy(chunk, &ch, sizeof(ch));
+        totalRows += rows;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fullChunks.push_back(chunk);
+        }
+        cv.notify_all();
+        chunk = nullptr;
+        nextChunk();
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            cv.wait(lock, [this] { return stopping || !fullChunks.empty(); });
+            if (fullChunks.empty()) return;  // stopping si nimic de scris
+            char* p = fullChunks.front();
+            fullChunks.erase(fullChunks.begin());
+            lock.unlock();
+            if (fwrite(p, 1, (size_t)header.chunkBytes, file) != header.chunkBytes) ioError = true;
+            lock.lock();
+            freeChunks.push_back(p);
+            cv.notify_all();
+        }
+    }
+};
+
+// ------------------------- READER -------------------------
+struct MappedTrajectory {
+    void* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    const TrajectoryHeader* header = nullptr;
+    uint64_t numChunks = 0;
+
+    const TrajectoryChunkHeader* chunkHeader(uint64_t c) const {
+        return (const TrajectoryChunkHeader*)((const char*)base + header->headerSize + c * header->chunkBytes);
+    }
+    // Coloana col din chunk-ul c: chunkHeader(c)->rows elemente de columnWidth[col] bytes.
+    const void* column(uint64_t c, int col) const {
+        return (const char*)chunkHeader(c) + header->columnOffset[col];
+    }
+};
+
+inline void unmapTrajectory(MappedTrajectory& m) {
+#ifdef _WIN32
+    if (m.base) UnmapViewOfFile(m.base);
+    if (m.mapping) CloseHandle(m.mapping);
+    if (m.file != INVALID_HANDLE_VALUE) CloseHandle(m.file);
+    m.file = INVALID_HANDLE_VALUE; m.mapping = nullptr;
+#else
+    if (m.base) munmap(m.base, m.size);
+#endif
+    m.base = nullptr; m.size = 0; m.header = nullptr; m.numChunks = 0;
+}
+
+inline bool mapTrajectory(const char* path, MappedTrajectory& m) {
+#ifdef _WIN32
+    m.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m.file == INVALID_HANDLE_VALUE) { fprintf(stderr, "trajectory: cannot open %s\n", path); return false; }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(m.file, &sz)) { unmapTrajectory(m); return false; }
+    m.size = (size_t)sz.QuadPart;
+    m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m.mapping) { unmapTrajectory(m); return false; }
+    m.base = MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m.base) { unmapTrajectory(m); return false; }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "trajectory: cannot open %s\n", path); return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    m.size = (size_t)st.st_size;
+    void* p = m.size ? mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (p == MAP_FAILED) { fprintf(stderr, "trajectory: mmap failed for %s\n", path); m.size = 0; return false; }
+    m.base = p;
+#endif
+    const TrajectoryHeader* h = (const TrajectoryHeader*)m.base;
+    if (m.size < TRAJ_BLOCK || memcmp(h->magic, TRAJ_MAGIC, 8) != 0 || h->version != TRAJ_VERSION ||
+        h->headerSize != TRAJ_BLOCK || h->numColumns != TRAJ_NUM_COLUMNS || h->chunkBytes == 0) {
+        fprintf(stderr, "trajectory: %s is not a trajectory file\n", path); unmapTrajectory(m); return false;
+    }
+    m.header = h;
+    // fisier neinchis (proces oprit): doar chunk-urile scrise complet
+    uint64_t available = (m.size - h->headerSize) / h->chunkBytes;
+    m.numChunks = h->numChunks && h->numChunks <= available ? h->numChunks : available;
+    return true;
+}